@@ -0,0 +1,410 @@
+// Benchmarks for the simulation hot paths. Prints one JSON document to stdout:
+//   wildfire_bench [--min-size N] [--max-size N] [--steps N] [--threads N]
+//                  [--mode active|full|bitplane] [--min-time SECONDS]
+#include "FireSimulation.h"
+#include "ArrivalTime.h"
+#include "DomainDecomposition.h"
+#include "FuelLayer.h"
+#include "RasterImport.h"
+#include "ThreadPool.h"
+#include "BurnKernel.h"
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+struct BenchConfig {
+    int min_size = 64;
+    int max_size = 8192;
+    int steps = 10;             // Grid updates per repetition of an update case
+    int threads = 1;
+    UpdateMode mode = UpdateMode::ACTIVE_FRONT;
+    double min_time = 0.5;      // Wall-clock seconds each case runs for, at least
+};
+
+// Swallows displayWithCrews output so only the formatting is measured
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Starts a new peak for peakRssKb(), so each case reports its own rather than
+// the largest case so far. Linux only; elsewhere the peak is process-wide.
+void resetPeakRss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+}
+
+// Peak resident set in kilobytes since the last resetPeakRss()
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::atol(line.c_str() + 6);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;  // Kilobytes on Linux
+}
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Calls fn in growing batches until min_time has passed; returns seconds and sets calls
+template <typename Fn>
+double timeCalls(Fn&& fn, double min_time, long& calls) {
+    calls = 0;
+    long batch = 1;
+    double start = now();
+    double elapsed = 0.0;
+    while (elapsed < min_time) {
+        for (long i = 0; i < batch; ++i) {
+            fn();
+        }
+        calls += batch;
+        elapsed = now() - start;
+        if (batch < (1L << 20)) batch *= 2;
+    }
+    return elapsed;
+}
+
+std::vector<std::string> results;
+
+void addResult(const std::string& json) {
+    results.push_back(json);
+}
+
+const char* modeName(UpdateMode mode) {
+    switch (mode) {
+        case UpdateMode::FULL_SCAN: return "full";
+        case UpdateMode::BITPLANE: return "bitplane";
+        default: return "active";
+    }
+}
+
+// Trees burn for several minutes of simulated time, so the front stays
+// roughly as dense as it started while a case runs
+void fillForest(Grid& grid) {
+    for (int y = 0; y < grid.getHeight(); ++y) {
+        for (int x = 0; x < grid.getWidth(); ++x) {
+            grid.setCell(x, y, Cell(FuelType::TREE, 0.9, 0.3));
+        }
+    }
+}
+
+// front: "point" = one fire in the centre, "line" = a burning column,
+// otherwise a fraction of randomly chosen burning cells
+void igniteFront(Grid& grid, const std::string& front) {
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    if (front == "point") {
+        grid.igniteCell(width / 2, height / 2);
+    } else if (front == "line") {
+        for (int y = 0; y < height; ++y) {
+            grid.igniteCell(width / 2, y);
+        }
+    } else {
+        double fraction = std::atof(front.c_str());
+        CounterRng rng(1234);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (rng.uniform(0, static_cast<uint64_t>(y) * width + x, CounterRng::TERRAIN) < fraction) {
+                    grid.igniteCell(x, y);
+                }
+            }
+        }
+    }
+}
+
+void benchGridUpdate(const BenchConfig& config, ThreadPool& pool) {
+    const char* fronts[] = {"point", "line", "0.1", "0.5"};
+    // Doubling sizes, always ending on max_size
+    std::vector<int> sizes;
+    for (int size = config.min_size; size < config.max_size; size *= 2) {
+        sizes.push_back(size);
+    }
+    sizes.push_back(config.max_size);
+    
+    for (int size : sizes) {
+        Grid base(size, size);
+        base.setSeed(42);
+        base.setUpdateMode(config.mode);
+        base.setThreadPool(&pool);
+        fillForest(base);
+        
+        for (const char* front : fronts) {
+            // The reset keeps what is resident now, so the peak includes base
+            resetPeakRss();
+            Grid ignited = base;
+            igniteFront(ignited, front);
+            
+            // Every repetition starts from the same front, so the work per step
+            // does not depend on how fast the previous repetitions ran
+            Grid grid = ignited;
+            long repetitions = 0;
+            double seconds = 0.0;
+            double case_start = now();
+            while (now() - case_start < config.min_time || repetitions == 0) {
+                grid = ignited;
+                double start = now();
+                for (int step = 0; step < config.steps; ++step) {
+                    grid.update(0.1);
+                }
+                seconds += now() - start;
+                ++repetitions;
+            }
+            
+            double cells = static_cast<double>(size) * size;
+            double steps = static_cast<double>(repetitions) * config.steps;
+            std::ostringstream json;
+            json << "{\"name\":\"grid_update\",\"size\":" << size
+                 << ",\"cells\":" << static_cast<long long>(cells)
+                 << ",\"front\":\"" << front << "\""
+                 << ",\"burning_at_start\":" << ignited.getBurningCount()
+                 << ",\"burning_at_end\":" << grid.getBurningCount()
+                 << ",\"steps\":" << config.steps
+                 << ",\"repetitions\":" << repetitions
+                 << ",\"ns_per_step\":" << seconds / steps * 1e9
+                 << ",\"cells_per_sec\":" << cells * steps / seconds
+                 << ",\"peak_rss_kb\":" << peakRssKb() << "}";
+            addResult(json.str());
+        }
+    }
+}
+
+// Per-call cost of the public helpers on a 256x256 grid with a dense front
+void benchOperations(const BenchConfig& config) {
+    const int size = 256;
+    FireSimulation sim(size, size);
+    sim.setSeed(42);
+    sim.setThreadCount(config.threads);
+    Grid& grid = sim.getGrid();
+    grid.setUpdateMode(config.mode);
+    fillForest(grid);
+    igniteFront(grid, "0.1");
+    sim.getHumanManager().addCrew("Alpha", CrewType::GROUND_CREW, 10, 10);
+    sim.getHumanManager().addCrew("Bravo", CrewType::AIR_TANKER, 200, 100);
+    sim.start();
+    
+    auto report = [&](const char* name, long calls, double seconds, long items_per_call) {
+        std::ostringstream json;
+        json << "{\"name\":\"" << name << "\",\"size\":" << size
+             << ",\"calls\":" << calls
+             << ",\"ns_per_call\":" << seconds / calls * 1e9;
+        if (items_per_call > 1) {
+            json << ",\"items_per_call\":" << items_per_call
+                 << ",\"items_per_sec\":" << static_cast<double>(items_per_call) * calls / seconds;
+        }
+        json << ",\"peak_rss_kb\":" << peakRssKb() << "}";
+        addResult(json.str());
+        resetPeakRss();
+    };
+    resetPeakRss();
+    
+    long calls;
+    double seconds;
+    volatile double spread_sink = 0.0;
+    int cursor = 0;
+    seconds = timeCalls([&]() {
+        int x = 1 + cursor % (size - 2);
+        int y = 1 + (cursor / (size - 2)) % (size - 2);
+        spread_sink = spread_sink + grid.calculateSpreadProbability(x, y, x + 1, y + 1);
+        ++cursor;
+    }, config.min_time, calls);
+    report("calculateSpreadProbability", calls, seconds, 1);
+    
+    volatile size_t neighbor_sink = 0;
+    cursor = 0;
+    seconds = timeCalls([&]() {
+        neighbor_sink = neighbor_sink + grid.getNeighbors(cursor % size, (cursor / size) % size).size();
+        ++cursor;
+    }, config.min_time, calls);
+    report("getNeighbors", calls, seconds, 1);
+    
+    cursor = 0;
+    seconds = timeCalls([&]() {
+        grid.applyWaterDrop(cursor % size, (cursor / size) % size, 5, 0.8, 30.0);
+        ++cursor;
+    }, config.min_time, calls);
+    report("applyWaterDrop", calls, seconds, 1);
+    
+    cursor = 0;
+    seconds = timeCalls([&]() {
+        grid.applyRetardant(cursor % size, (cursor / size) % size, 5, 0.9, 60.0);
+        ++cursor;
+    }, config.min_time, calls);
+    report("applyRetardant", calls, seconds, 1);
+    
+    // An air attack's worth of drops per step, a quarter of them repeats
+    const int drops_per_batch = 256;
+    SuppressionQueue& queue = sim.getSuppressionQueue();
+    cursor = 0;
+    seconds = timeCalls([&]() {
+        for (int i = 0; i < drops_per_batch; ++i, ++cursor) {
+            int spot = cursor % (drops_per_batch * 3 / 4);
+            SuppressionAction drop;
+            drop.type = (i & 1) ? SuppressionType::RETARDANT : SuppressionType::WATER;
+            drop.x = (spot * 37) % size;
+            drop.y = (spot * 91) % size;
+            drop.end_x = drop.x;
+            drop.end_y = drop.y;
+            drop.radius = 5;
+            drop.effectiveness = 0.8;
+            drop.duration = 30.0;
+            drop.cost = 0.0;
+            queue.push(drop);
+        }
+        queue.apply(grid);
+    }, config.min_time, calls);
+    report("suppressionQueue", calls, seconds, drops_per_batch);
+    
+    ArrivalTimeSolver arrival;
+    seconds = timeCalls([&]() { arrival.solve(grid); }, config.min_time, calls);
+    report("arrivalTimeSolve", calls, seconds, static_cast<long>(size) * size);
+    
+    // config.steps steps of the forest with the same fire split over two
+    // processes, building the subdomains, fork and halo exchange included
+    Landscape landscape;
+    landscape.fuel = FuelLayer::uniform(size, size, Cell(FuelType::TREE, 0.9, 0.3));
+    landscape.seed = grid.getSeed();
+    landscape.wind_speed = grid.getWindSpeed();
+    landscape.wind_direction = grid.getWindDirection();
+    landscape.ambient_temp = grid.getAmbientTemp();
+    landscape.humidity = grid.getHumidity();
+    landscape.spread_stencil = grid.getSpreadStencil();
+    landscape.update_mode = grid.getUpdateMode();
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (grid.getCellState(x, y) == CellState::BURNING) {
+                landscape.ignition_points.emplace_back(x, y);
+            }
+        }
+    }
+    DomainDecomposition decomposition(0.1);
+    std::string decomposition_error;
+    if (decomposition.partition(size, size, 2, decomposition_error)) {
+        seconds = timeCalls([&]() { decomposition.run(landscape, config.steps, -1, decomposition_error); },
+                            config.min_time, calls);
+        report("domainDecomposition", calls, seconds, static_cast<long>(size) * size * config.steps);
+    }
+    
+    NullBuffer null_buffer;
+    std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+    seconds = timeCalls([&]() { grid.displayWithCrews(sim.getHumanManager()); }, config.min_time, calls);
+    std::cout.rdbuf(saved);
+    report("displayWithCrews", calls, seconds, static_cast<long>(size) * size);
+    
+    seconds = timeCalls([&]() { sim.updateStatistics(); }, config.min_time, calls);
+    report("updateStatistics", calls, seconds, 1);
+    
+    seconds = timeCalls([&]() { sim.saveToFile("/dev/null"); }, config.min_time, calls);
+    report("saveToFile", calls, seconds, static_cast<long>(size) * size);
+    
+    // The grid's fuel types written as an ESRI ASCII grid and as an 8-bit
+    // binary raster, then read back
+    char directory[] = "/tmp/wildfire_bench_XXXXXX";
+    if (mkdtemp(directory)) {
+        std::string base = std::string(directory) + "/fuel";
+        std::ofstream ascii(base + ".asc");
+        std::ofstream binary(base + ".bil", std::ios::binary);
+        std::ofstream header(base + ".hdr");
+        ascii << "ncols " << size << "\nnrows " << size << "\n";
+        header << "ncols " << size << "\nnrows " << size << "\nnbits 8\n";
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                char code = static_cast<char>(grid.getCell(x, y).getFuelType());
+                ascii << static_cast<int>(code) << (x + 1 < size ? ' ' : '\n');
+                binary.put(code);
+            }
+        }
+        ascii.close();
+        binary.close();
+        header.close();
+        
+        ThreadPool pool(config.threads);
+        FuelLayer layer;
+        std::string import_error;
+        seconds = timeCalls([&]() { RasterImport::load(base + ".asc", "", "", &pool, layer, import_error); },
+                            config.min_time, calls);
+        report("rasterImportAscii", calls, seconds, static_cast<long>(size) * size);
+        seconds = timeCalls([&]() { RasterImport::load(base + ".bil", "", "", &pool, layer, import_error); },
+                            config.min_time, calls);
+        report("rasterImportBinary", calls, seconds, static_cast<long>(size) * size);
+        
+        unlink((base + ".asc").c_str());
+        unlink((base + ".bil").c_str());
+        unlink((base + ".hdr").c_str());
+        rmdir(directory);
+    }
+    
+    // Last, since it replaces the grid's fuel; bands run on the simulation's pool
+    seconds = timeCalls([&]() { grid.initializeProcedural(); }, config.min_time, calls);
+    report("proceduralTerrain", calls, seconds, static_cast<long>(size) * size);
+}
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--min-size") {
+            config.min_size = std::atoi(value.c_str());
+        } else if (arg == "--max-size") {
+            config.max_size = std::atoi(value.c_str());
+        } else if (arg == "--steps") {
+            config.steps = std::atoi(value.c_str());
+        } else if (arg == "--threads") {
+            config.threads = std::atoi(value.c_str());
+        } else if (arg == "--min-time") {
+            config.min_time = std::atof(value.c_str());
+        } else if (arg == "--mode" && value == "active") {
+            config.mode = UpdateMode::ACTIVE_FRONT;
+        } else if (arg == "--mode" && value == "full") {
+            config.mode = UpdateMode::FULL_SCAN;
+        } else if (arg == "--mode" && value == "bitplane") {
+            config.mode = UpdateMode::BITPLANE;
+        } else {
+            return false;
+        }
+    }
+    return config.min_size > 0 && config.max_size >= config.min_size &&
+           config.steps > 0 && config.threads > 0 && config.min_time > 0.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        std::cerr << "Usage: " << argv[0] << " [--min-size N] [--max-size N] [--steps N]"
+                  << " [--threads N] [--mode active|full|bitplane] [--min-time SECONDS]\n";
+        return 1;
+    }
+    
+    ThreadPool pool(config.threads);
+    benchOperations(config);
+    benchGridUpdate(config, pool);
+    
+    std::cout << "{\"benchmark\":\"wildfire_bench\""
+              << ",\"threads\":" << config.threads
+              << ",\"steps\":" << config.steps
+              << ",\"mode\":\"" << modeName(config.mode) << "\""
+              << ",\"burn_kernel\":\"" << getBurnKernelIsaName(getBurnKernelIsa()) << "\""
+              << ",\"results\":[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::cout << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    std::cout << "]}\n";
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Equivalence check for the burn kernels. Every instruction set the host
+// supports must match the scalar kernel bit for bit, and the scalar kernel
+// must agree with Cell::update within the quantization documented in
+// BurnKernel.h. Exits non-zero on the first mismatch:
+//   burn_kernel_check [--trials N] [--seed N]
+#include "BurnKernel.h"
+#include "Cell.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float kBurnDurations[5] = {30.0f, 120.0f, 300.0f, 30.0f, 30.0f};
+
+// Owns the arrays a BurnSpan points into
+struct SpanData {
+    std::vector<uint8_t> states, fuel_types, fuel_densities, moistures;
+    std::vector<int16_t> temperatures;
+    std::vector<float> burn_times;
+
+    explicit SpanData(int count)
+        : states(count), fuel_types(count), fuel_densities(count), moistures(count),
+          temperatures(count), burn_times(count) {}
+
+    BurnSpan span() {
+        return BurnSpan{states.data(), fuel_types.data(), fuel_densities.data(), moistures.data(),
+                        temperatures.data(), burn_times.data(), static_cast<int>(states.size())};
+    }
+};
+
+// Random cells in every state and fuel type. A share of the burning cells sit
+// on the burnout boundary: burn time one step short of the duration, give or
+// take a few ulps.
+SpanData randomSpan(std::mt19937_64& rng, int count, float dt) {
+    SpanData data(count);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> state(0, 3);
+    std::uniform_int_distribution<int> fuel(0, 4);
+    std::uniform_int_distribution<int> temperature(-32768, 32767);
+    std::uniform_int_distribution<int> ulps(-4, 4);
+    std::uniform_real_distribution<float> burn_time(0.0f, 700.0f);
+
+    for (int i = 0; i < count; ++i) {
+        // Mostly burning, so most vector blocks do work
+        data.states[i] = static_cast<uint8_t>(byte(rng) < 160 ? static_cast<int>(CellState::BURNING) : state(rng));
+        data.fuel_types[i] = static_cast<uint8_t>(fuel(rng));
+        data.fuel_densities[i] = static_cast<uint8_t>(byte(rng));
+        data.moistures[i] = static_cast<uint8_t>(byte(rng));
+        data.temperatures[i] = static_cast<int16_t>(temperature(rng));
+        data.burn_times[i] = burn_time(rng);
+
+        if (byte(rng) < 64) {
+            float duration = kBurnDurations[data.fuel_types[i]] * (data.fuel_densities[i] / 255.0f) *
+                             (1.0f + data.moistures[i] / 255.0f);
+            float boundary = std::max(0.0f, duration - dt);
+            int steps = ulps(rng);
+            for (; steps > 0; --steps) boundary = std::nextafter(boundary, 1e9f);
+            for (; steps < 0; ++steps) boundary = std::nextafter(boundary, 0.0f);
+            data.burn_times[i] = boundary;
+        }
+    }
+    return data;
+}
+
+bool fail(const char* what, BurnKernelIsa isa, int trial, int cell) {
+    std::fprintf(stderr, "burn_kernel_check: %s: %s differs at trial %d, cell %d\n", what,
+                 getBurnKernelIsaName(isa), trial, cell);
+    return false;
+}
+
+// Every supported vector kernel against the scalar one
+bool checkIsas(const SpanData& input, float dt, int trial) {
+    SpanData reference = input;
+    int reference_burnouts = burnProgress(reference.span(), dt, BurnKernelIsa::SCALAR);
+
+    for (BurnKernelIsa isa : {BurnKernelIsa::SSE2, BurnKernelIsa::AVX2, BurnKernelIsa::AVX512}) {
+        if (!isBurnKernelIsaSupported(isa)) continue;
+
+        SpanData result = input;
+        int burnouts = burnProgress(result.span(), dt, isa);
+        if (burnouts != reference_burnouts) return fail("burnout count", isa, trial, -1);
+        for (size_t i = 0; i < input.states.size(); ++i) {
+            if (result.states[i] != reference.states[i] || result.fuel_densities[i] != reference.fuel_densities[i] ||
+                result.temperatures[i] != reference.temperatures[i] ||
+                std::memcmp(&result.burn_times[i], &reference.burn_times[i], sizeof(float)) != 0) {
+                return fail("cell", isa, trial, static_cast<int>(i));
+            }
+        }
+    }
+    return true;
+}
+
+// The scalar kernel against Cell::update, cell by cell
+bool checkCellUpdate(const SpanData& input, float dt, int trial) {
+    SpanData result = input;
+    burnProgress(result.span(), dt, BurnKernelIsa::SCALAR);
+
+    for (size_t i = 0; i < input.states.size(); ++i) {
+        if (input.states[i] != static_cast<uint8_t>(CellState::BURNING)) continue;
+
+        Cell cell(static_cast<FuelType>(input.fuel_types[i]), input.fuel_densities[i] / 255.0,
+                  input.moistures[i] / 255.0);
+        cell.setState(CellState::BURNING);
+        cell.setFuelDensity(input.fuel_densities[i] / 255.0);
+        cell.setBurnTime(input.burn_times[i]);
+        cell.update(dt);
+
+        double duration = kBurnDurations[input.fuel_types[i]] * (input.fuel_densities[i] / 255.0) *
+                          (1.0 + input.moistures[i] / 255.0);
+        // Float and double may only disagree on burnout within float rounding
+        // of the duration
+        bool near_boundary = std::fabs(cell.getBurnTime() - duration) <= 1e-5 * (duration + 1.0);
+        bool burned = result.states[i] == static_cast<uint8_t>(CellState::BURNED);
+        if (burned != (cell.getState() == CellState::BURNED)) {
+            if (near_boundary) continue;
+            return fail("state vs Cell::update", BurnKernelIsa::SCALAR, trial, static_cast<int>(i));
+        }
+        if (result.fuel_densities[i] != static_cast<uint8_t>(std::lround(cell.getFuelDensity() * 255.0))) {
+            return fail("density vs Cell::update", BurnKernelIsa::SCALAR, trial, static_cast<int>(i));
+        }
+        if (std::fabs(result.burn_times[i] - cell.getBurnTime()) > 1e-6 * (cell.getBurnTime() + 1.0)) {
+            return fail("burn time vs Cell::update", BurnKernelIsa::SCALAR, trial, static_cast<int>(i));
+        }
+        // Tenths of a degree, plus float rounding of the burn progress
+        if (!near_boundary &&
+            std::fabs(result.temperatures[i] / 10.0 - cell.getTemperature()) > 0.05 + 1e-3) {
+            return fail("temperature vs Cell::update", BurnKernelIsa::SCALAR, trial, static_cast<int>(i));
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int trials = 2000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--trials" && i + 1 < argc) {
+            trials = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--trials N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> count(0, 257);
+    const float steps[] = {0.1f, 0.05f, 0.5f, 1.0f, 7.3f};
+
+    for (int trial = 0; trial < trials; ++trial) {
+        float dt = steps[trial % 5];
+        SpanData input = randomSpan(rng, count(rng), dt);
+        if (!checkIsas(input, dt, trial) || !checkCellUpdate(input, dt, trial)) return 1;
+    }
+
+    std::printf("burn_kernel_check: %d trials, scalar", trials);
+    for (BurnKernelIsa isa : {BurnKernelIsa::SSE2, BurnKernelIsa::AVX2, BurnKernelIsa::AVX512}) {
+        if (isBurnKernelIsaSupported(isa)) std::printf(", %s", getBurnKernelIsaName(isa));
+    }
+    std::printf(": ok\n");
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Round-trip check for frame streams. A run is recorded with crews moving
+// and suppression landing and wearing off, while the cell codes of every
+// step are also taken from the grid through its public accessors. The
+// reader must then decode each frame to exactly those codes, whether frames
+// are read forwards, backwards, across keyframes or in random order. Exits
+// non-zero on the first mismatch:
+//   frame_stream_check [--steps N] [--seeks N] [--seed N]
+#include "FireSimulation.h"
+#include "FrameRecorder.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kWidth = 150;      // Not a multiple of eight, so the capture's tail loop runs
+const int kHeight = 90;
+const int kRecordEvery = 3;
+const int kKeyframeEvery = 5;
+
+struct ExpectedFrame {
+    std::vector<uint8_t> codes;
+    double time;
+};
+
+// The frame cell codes (see FrameRecorder.h), from the grid's accessors
+std::vector<uint8_t> gridCodes(const FireSimulation& sim) {
+    const Grid& grid = sim.getGrid();
+    std::vector<uint8_t> codes(static_cast<size_t>(kWidth) * kHeight);
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            SuppressionEffect effect = grid.getSuppressionEffect(x, y);
+            codes[static_cast<size_t>(y) * kWidth + x] = static_cast<uint8_t>(
+                static_cast<int>(grid.getCellState(x, y)) | (effect.water_level > 0 ? kFrameWater : 0) |
+                (effect.retardant_level > 0 ? kFrameRetardant : 0) | (effect.is_firebreak ? kFrameFirebreak : 0));
+        }
+    }
+    for (const FirefightingCrew& crew : sim.getHumanManager().getCrews()) {
+        codes[static_cast<size_t>(crew.getY()) * kWidth + crew.getX()] |= kFrameCrew;
+    }
+    return codes;
+}
+
+// Crews move and drop water and retardant that wears off within the run
+void orderDuringRun(FireSimulation& sim, int step) {
+    HumanFactorManager& human = sim.getHumanManager();
+    int alpha = human.getCrews()[0].getId();
+    int bravo = human.getCrews()[1].getId();
+    if (step % 17 == 5) human.deployCrewToLocation(alpha, 10 + step % 120, 20 + step % 60);
+    if (step == 30) human.orderSuppression(bravo, SuppressionType::WATER, kWidth / 2 + 3, kHeight / 2, 6);
+    if (step == 70) human.orderSuppression(bravo, SuppressionType::RETARDANT, 40, 60, 5);
+    if (step == 90) sim.addFirebreak(100, 10, 140, 30);
+    if (step == 120) {
+        sim.getGrid().applyWaterDrop(kWidth / 2, kHeight / 2 - 10, 7, 0.9, 4.0);
+        sim.getGrid().applyRetardant(30, 30, 3, 0.8, 2.5);
+    }
+}
+
+bool fail(const std::string& what) {
+    std::fprintf(stderr, "frame_stream_check: %s\n", what.c_str());
+    return false;
+}
+
+bool checkFrame(FrameReader& reader, int frame, const std::map<uint32_t, ExpectedFrame>& expected,
+                const char* order) {
+    std::vector<uint8_t> codes;
+    std::string error;
+    if (!reader.seek(frame, codes, error)) return fail(std::string(order) + " seek: " + error);
+    auto found = expected.find(reader.getFrameStep(frame));
+    if (found == expected.end()) {
+        return fail("frame " + std::to_string(frame) + " has step " + std::to_string(reader.getFrameStep(frame)) +
+                    ", which was never run");
+    }
+    if (reader.getFrameTime(frame) != found->second.time) {
+        return fail("frame " + std::to_string(frame) + " has the wrong time");
+    }
+    const std::vector<uint8_t>& want = found->second.codes;
+    if (codes.size() != want.size()) return fail("frame " + std::to_string(frame) + " has the wrong size");
+    for (size_t i = 0; i < want.size(); ++i) {
+        if (codes[i] != want[i]) {
+            return fail(std::string(order) + ": frame " + std::to_string(frame) + " cell " +
+                        std::to_string(i % kWidth) + "," + std::to_string(i / kWidth) + " decodes to " +
+                        std::to_string(codes[i]) + ", the grid had " + std::to_string(want[i]));
+        }
+    }
+    return true;
+}
+
+bool checkStream(const std::string& path, int steps, int seeks, uint64_t seed) {
+    FireSimulation sim(kWidth, kHeight);
+    sim.setSeed(seed);
+    sim.setupMixed();
+    sim.addIgnitionPoint(kWidth / 2, kHeight / 2);
+    sim.addIgnitionPoint(kWidth - 1, kHeight - 1);
+    sim.getHumanManager().addCrew("Alpha", CrewType::GROUND_CREW, 5, 5);
+    sim.getHumanManager().addCrew("Bravo", CrewType::AIR_TANKER, kWidth - 1, 0);
+
+    std::string error;
+    std::map<uint32_t, ExpectedFrame> expected;
+    if (!sim.startRecording(path, kRecordEvery, kKeyframeEvery, error)) return fail("record: " + error);
+    expected[sim.getGrid().getStepCount()] = ExpectedFrame{gridCodes(sim), sim.getTotalTime()};
+    sim.start();
+    for (int step = 0; step < steps; ++step) {
+        orderDuringRun(sim, step);
+        sim.step();
+        expected[sim.getGrid().getStepCount()] = ExpectedFrame{gridCodes(sim), sim.getTotalTime()};
+    }
+    if (!sim.stopRecording(error)) return fail("record: " + error);
+    long written = sim.getRecorder()->getFramesWritten();
+
+    FrameReader reader;
+    if (!reader.open(path, error)) return fail("open: " + error);
+    int count = reader.getFrameCount();
+    if (count != written || count != 1 + steps / kRecordEvery) {
+        return fail(std::to_string(count) + " frames read, " + std::to_string(written) + " written");
+    }
+
+    for (int f = 0; f < count; ++f) {
+        if (!checkFrame(reader, f, expected, "forwards")) return false;
+    }
+    for (int f = count - 1; f >= 0; --f) {
+        if (!checkFrame(reader, f, expected, "backwards")) return false;
+    }
+    // Just before and after every keyframe, in both directions, and the same frame twice
+    for (int k = kKeyframeEvery; k < count; k += kKeyframeEvery) {
+        for (int f : {k - 1, k, k - 1, k + 1, k - 2, k + kKeyframeEvery - 1, k + 1, k + 1}) {
+            if (f < count && !checkFrame(reader, f, expected, "across keyframes")) return false;
+        }
+    }
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    std::uniform_int_distribution<int> any_frame(0, count - 1);
+    FrameReader fresh;
+    if (!fresh.open(path, error)) return fail("open: " + error);
+    for (int i = 0; i < seeks; ++i) {
+        if (!checkFrame(reader, any_frame(rng), expected, "random") ||
+            !checkFrame(fresh, any_frame(rng), expected, "random")) {
+            return false;
+        }
+    }
+
+    std::vector<uint8_t> codes;
+    if (reader.seek(count, codes, error) || reader.seek(-1, codes, error)) {
+        return fail("a frame out of range was decoded");
+    }
+    std::printf("frame_stream_check: %d frames, %d random seeks\n", count, seeks);
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int steps = 300;
+    int seeks = 2000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--steps" && i + 1 < argc) {
+            steps = std::atoi(argv[++i]);
+        } else if (arg == "--seeks" && i + 1 < argc) {
+            seeks = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--steps N] [--seeks N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    char directory[] = "/tmp/frame_stream_check_XXXXXX";
+    if (!mkdtemp(directory)) {
+        std::perror("frame_stream_check: mkdtemp");
+        return 1;
+    }
+    std::string path = std::string(directory) + "/run.frames";
+    bool ok = checkStream(path, steps, seeks, seed);
+    std::remove(path.c_str());
+    rmdir(directory);
+    if (!ok) return 1;
+
+    std::printf("frame_stream_check: every decoded frame matches the grid: ok\n");
+    return 0;
+}
@@ -0,0 +1,292 @@
+// Round-trip check for snapshots. A run saved mid-way, restored into another
+// simulation and continued must match the run that never stopped, bit for
+// bit. A snapshot with any field, the header or the metadata corrupted, or
+// cut short anywhere, must be rejected and leave the simulation unchanged.
+// Exits non-zero on the first failure:
+//   snapshot_check [--steps N] [--seed N]
+#include "FireSimulation.h"
+#include "Snapshot.h"
+#include <unistd.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kWidth = 120;
+const int kHeight = 96;
+
+// Mixed fuel, two fires, a firebreak, two crews and an evacuation zone
+void setupSimulation(FireSimulation& sim, uint64_t seed) {
+    sim.setSeed(seed);
+    sim.setupMixed();
+    sim.getGrid().setWindSpeed(7.0);
+    sim.getGrid().setWindDirection(45.0);
+    sim.addFirebreak(10, 70, 90, 72);
+    sim.addIgnitionPoint(kWidth / 2, kHeight / 2);
+    sim.addIgnitionPoint(20, 20);
+    HumanFactorManager& human = sim.getHumanManager();
+    human.addCrew("Alpha", CrewType::GROUND_CREW, 30, 30);
+    human.addCrew("Bravo", CrewType::AIR_TANKER, 90, 40);
+    human.addEvacuationZone("Ridge", 80, 60, 8, 120);
+}
+
+// Drops and moves during the run, before and after the save
+void orderDuringRun(FireSimulation& sim, int step, int save_step) {
+    HumanFactorManager& human = sim.getHumanManager();
+    int alpha = human.getCrews()[0].getId();
+    int bravo = human.getCrews()[1].getId();
+    if (step == 10) human.orderSuppression(bravo, SuppressionType::RETARDANT, kWidth / 2 + 5, kHeight / 2, 4);
+    if (step == 25) human.deployCrewToLocation(alpha, 40, 35);
+    if (step == save_step + 15) human.orderEvacuation(0);
+}
+
+// Ordered just before the save, so the snapshot holds them still queued
+void orderBeforeSave(FireSimulation& sim) {
+    HumanFactorManager& human = sim.getHumanManager();
+    human.orderSuppression(human.getCrews()[1].getId(), SuppressionType::WATER, kWidth / 2 - 4, kHeight / 2 + 3, 5);
+    human.orderSuppression(human.getCrews()[0].getId(), SuppressionType::FIREBREAK, 25, 10, 12);
+}
+
+bool fail(const std::string& what) {
+    std::fprintf(stderr, "snapshot_check: %s\n", what.c_str());
+    return false;
+}
+
+// Bit for bit, so a crew without a retardant tank (level 0 / 0) matches itself
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Every cell field, the suppression, the clock, counts, crews and zones
+bool sameSimulation(const FireSimulation& a, const FireSimulation& b, std::string& difference) {
+    const Grid& ga = a.getGrid();
+    const Grid& gb = b.getGrid();
+    if (ga.getWidth() != gb.getWidth() || ga.getHeight() != gb.getHeight()) {
+        difference = "grid size";
+        return false;
+    }
+    for (int y = 0; y < ga.getHeight(); ++y) {
+        for (int x = 0; x < ga.getWidth(); ++x) {
+            Cell ca = ga.getCell(x, y);
+            Cell cb = gb.getCell(x, y);
+            SuppressionEffect sa = ga.getSuppressionEffect(x, y);
+            SuppressionEffect sb = gb.getSuppressionEffect(x, y);
+            if (ca.getState() != cb.getState() || ca.getFuelType() != cb.getFuelType() ||
+                ca.getFuelDensity() != cb.getFuelDensity() || ca.getMoisture() != cb.getMoisture() ||
+                ca.getTemperature() != cb.getTemperature() || ca.getBurnTime() != cb.getBurnTime() ||
+                sa.water_level != sb.water_level || sa.retardant_level != sb.retardant_level ||
+                sa.remaining_time != sb.remaining_time || sa.is_firebreak != sb.is_firebreak) {
+                difference = "cell " + std::to_string(x) + "," + std::to_string(y);
+                return false;
+            }
+        }
+    }
+    if (ga.getSeed() != gb.getSeed() || ga.getStepCount() != gb.getStepCount() || ga.getClock() != gb.getClock() ||
+        a.getTotalTime() != b.getTotalTime()) {
+        difference = "seed, step or clock";
+        return false;
+    }
+    if (a.getCellsBurning() != b.getCellsBurning() || a.getCellsBurned() != b.getCellsBurned() ||
+        a.getTotalFuelCells() != b.getTotalFuelCells()) {
+        difference = "cell counts";
+        return false;
+    }
+
+    const HumanFactorManager& ha = a.getHumanManager();
+    const HumanFactorManager& hb = b.getHumanManager();
+    if (ha.getRemainingBudget() != hb.getRemainingBudget() || ha.getCrews().size() != hb.getCrews().size()) {
+        difference = "budget or crew count";
+        return false;
+    }
+    for (size_t i = 0; i < ha.getCrews().size(); ++i) {
+        const FirefightingCrew& ca = ha.getCrews()[i];
+        const FirefightingCrew& cb = hb.getCrews()[i];
+        if (ca.getId() != cb.getId() || ca.getX() != cb.getX() || ca.getY() != cb.getY() ||
+            !sameBits(ca.getWaterLevel(), cb.getWaterLevel()) ||
+            !sameBits(ca.getRetardantLevel(), cb.getRetardantLevel()) ||
+            ca.getFatigue() != cb.getFatigue() || ca.isAvailable() != cb.isAvailable()) {
+            difference = "crew " + std::to_string(i);
+            return false;
+        }
+    }
+    const std::vector<EvacuationZone>& za = ha.getEvacuationZones();
+    const std::vector<EvacuationZone>& zb = hb.getEvacuationZones();
+    if (za.size() != zb.size()) {
+        difference = "zone count";
+        return false;
+    }
+    for (size_t i = 0; i < za.size(); ++i) {
+        if (za[i].evacuated != zb[i].evacuated || za[i].evacuation_ordered != zb[i].evacuation_ordered ||
+            za[i].danger_level != zb[i].danger_level) {
+            difference = "zone " + std::to_string(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readFile(const std::string& path, std::vector<char>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return file.good() || file.eof();
+}
+
+bool writeFile(const std::string& path, const char* bytes, size_t count) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes, static_cast<std::streamsize>(count));
+    return file.good();
+}
+
+// Loading path into sim must fail and leave it as it was
+bool checkRejected(FireSimulation& sim, const FireSimulation& before, const std::string& path,
+                   const std::string& what) {
+    std::string error;
+    if (sim.loadSnapshot(path, error)) return fail(what + " was accepted");
+    std::string difference;
+    if (!sameSimulation(sim, before, difference)) {
+        return fail(what + " was rejected (" + error + ") but changed the simulation: " + difference);
+    }
+    return true;
+}
+
+bool checkRoundTrip(const std::string& directory, int steps, uint64_t seed) {
+    const int save_step = steps / 3;
+    std::string path = directory + "/run.snap";
+    std::string error;
+
+    FireSimulation uninterrupted(kWidth, kHeight);
+    setupSimulation(uninterrupted, seed);
+    uninterrupted.start();
+    for (int step = 0; step < save_step; ++step) {
+        orderDuringRun(uninterrupted, step, save_step);
+        uninterrupted.step();
+    }
+    orderBeforeSave(uninterrupted);
+    if (uninterrupted.getSuppressionQueue().empty()) return fail("no suppression was queued at the save");
+    if (!uninterrupted.saveSnapshot(path, error)) return fail("save: " + error);
+
+    // A simulation with other contents, so nothing matches by accident
+    FireSimulation restored(kWidth, kHeight);
+    setupSimulation(restored, seed + 1);
+    restored.setupForest();
+    if (!restored.loadSnapshot(path, error)) return fail("load: " + error);
+    std::string difference;
+    if (!sameSimulation(uninterrupted, restored, difference)) return fail("restored state differs: " + difference);
+
+    restored.start();
+    for (int step = save_step; step < steps; ++step) {
+        orderDuringRun(uninterrupted, step, save_step);
+        uninterrupted.step();
+        orderDuringRun(restored, step, save_step);
+        restored.step();
+        if (!sameSimulation(uninterrupted, restored, difference)) {
+            return fail("continued run differs at step " + std::to_string(step) + ": " + difference);
+        }
+    }
+    if (uninterrupted.getCellsBurned() == 0) return fail("the fire never burned out a cell");
+    return true;
+}
+
+bool checkCorruption(const std::string& directory, uint64_t seed) {
+    std::string path = directory + "/good.snap";
+    std::string bad_path = directory + "/bad.snap";
+    std::string error;
+
+    FireSimulation source(kWidth, kHeight);
+    setupSimulation(source, seed);
+    source.runHeadless(40);
+    if (!source.saveSnapshot(path, error)) return fail("save: " + error);
+    std::vector<char> bytes;
+    if (!readFile(path, bytes) || bytes.size() < sizeof(SnapshotHeader)) return fail("cannot read " + path);
+
+    FireSimulation target(kWidth, kHeight);
+    setupSimulation(target, seed + 7);
+    target.runHeadless(5);
+    FireSimulation before(kWidth, kHeight);
+    setupSimulation(before, seed + 7);
+    before.runHeadless(5);
+
+    // One flipped bit in the middle of each region a checksum covers
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::vector<std::pair<uint64_t, std::string>> spots = {
+        {offsetof(SnapshotHeader, width), "header"},
+        {sizeof(SnapshotHeader) + 4, "field table"},
+        {header.metadata_offset + header.metadata_bytes / 2, "metadata"},
+    };
+    for (uint32_t i = 0; i < header.field_count; ++i) {
+        SnapshotField field;
+        std::memcpy(&field, bytes.data() + sizeof(SnapshotHeader) + i * sizeof(SnapshotField), sizeof(field));
+        spots.emplace_back(field.offset + field.bytes / 2, std::string("field ") + field.name);
+    }
+    for (const auto& spot : spots) {
+        if (spot.first >= bytes.size()) return fail(spot.second + " lies outside the file");
+        std::vector<char> corrupted = bytes;
+        corrupted[spot.first] ^= 0x10;
+        if (!writeFile(bad_path, corrupted.data(), corrupted.size())) return fail("cannot write " + bad_path);
+        if (!checkRejected(target, before, bad_path, "corrupted " + spot.second)) return false;
+    }
+
+    // Cut short at every region boundary and inside each region
+    std::vector<uint64_t> lengths = {0, 7, sizeof(SnapshotHeader) - 1, sizeof(SnapshotHeader),
+                                     header.header_bytes, header.metadata_offset,
+                                     header.metadata_offset + header.metadata_bytes / 2, bytes.size() - 1};
+    for (uint32_t i = 0; i < header.field_count; ++i) {
+        SnapshotField field;
+        std::memcpy(&field, bytes.data() + sizeof(SnapshotHeader) + i * sizeof(SnapshotField), sizeof(field));
+        lengths.push_back(field.offset + field.bytes / 2);
+    }
+    for (uint64_t length : lengths) {
+        if (!writeFile(bad_path, bytes.data(), static_cast<size_t>(length))) return fail("cannot write " + bad_path);
+        if (!checkRejected(target, before, bad_path, "file cut to " + std::to_string(length) + " bytes")) {
+            return false;
+        }
+    }
+
+    // The untouched file still loads
+    if (!target.loadSnapshot(path, error)) return fail("reload: " + error);
+    std::string difference;
+    if (!sameSimulation(target, source, difference)) return fail("reloaded state differs: " + difference);
+    std::printf("snapshot_check: %zu corruptions and %zu truncations rejected\n", spots.size(), lengths.size());
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int steps = 300;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--steps" && i + 1 < argc) {
+            steps = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--steps N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    char directory[] = "/tmp/snapshot_check_XXXXXX";
+    if (!mkdtemp(directory)) {
+        std::perror("snapshot_check: mkdtemp");
+        return 1;
+    }
+    bool ok = checkRoundTrip(directory, steps, seed) && checkCorruption(directory, seed);
+    for (const char* name : {"/run.snap", "/good.snap", "/bad.snap"}) {
+        std::remove((std::string(directory) + name).c_str());
+    }
+    rmdir(directory);
+    if (!ok) return 1;
+
+    std::printf("snapshot_check: saved at step %d of %d, restored run matches: ok\n", steps / 3, steps);
+    return 0;
+}
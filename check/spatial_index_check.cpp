@@ -0,0 +1,196 @@
+// Equivalence check for the crew and zone indexes. Random moves, adds,
+// copies and queries are run against a HumanFactorManager, and every query
+// must give what a linear scan of its crews or zones gives. Moves include
+// moving a copy of a crew, which must leave the index alone, and managers
+// that were copied or assigned. Exits non-zero on the first mismatch:
+//   spatial_index_check [--ops N] [--seed N]
+#include "FirefightingCrew.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Positions spill past the map on every side, into negative buckets
+const int kMin = -60;
+const int kMax = 1060;
+
+void scanCrewsWithin(const HumanFactorManager& human, int x, int y, int radius, std::vector<int>& ids) {
+    ids.clear();
+    if (radius < 0) return;
+    for (const FirefightingCrew& crew : human.getCrews()) {
+        int64_t dx = crew.getX() - x;
+        int64_t dy = crew.getY() - y;
+        if (dx * dx + dy * dy <= static_cast<int64_t>(radius) * radius) ids.push_back(crew.getId());
+    }
+}
+
+void scanZonesCovering(const HumanFactorManager& human, int x, int y, std::vector<int>& indices) {
+    indices.clear();
+    const std::vector<EvacuationZone>& zones = human.getEvacuationZones();
+    for (size_t i = 0; i < zones.size(); ++i) {
+        int64_t dx = x - zones[i].x;
+        int64_t dy = y - zones[i].y;
+        if (dx * dx + dy * dy <= static_cast<int64_t>(zones[i].radius) * zones[i].radius) {
+            indices.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+bool fail(int op, const std::string& what) {
+    std::fprintf(stderr, "spatial_index_check: op %d: %s\n", op, what.c_str());
+    return false;
+}
+
+class IndexCheck {
+private:
+    std::mt19937_64 rng;
+    std::vector<int> found, scanned;
+    long crew_queries = 0, zone_queries = 0, copied_moves = 0;
+
+    int coordinate() { return std::uniform_int_distribution<int>(kMin, kMax)(rng); }
+    int below(int n) { return std::uniform_int_distribution<int>(0, n - 1)(rng); }
+
+    bool checkCrewQuery(const HumanFactorManager& human, int op, int x, int y, int radius) {
+        human.findCrewsWithin(x, y, radius, found);
+        scanCrewsWithin(human, x, y, radius, scanned);
+        ++crew_queries;
+        if (found != scanned) {
+            return fail(op, "findCrewsWithin(" + std::to_string(x) + ", " + std::to_string(y) + ", " +
+                                std::to_string(radius) + ") found " + std::to_string(found.size()) +
+                                " crews, a scan " + std::to_string(scanned.size()));
+        }
+        return true;
+    }
+
+    bool checkZoneQuery(const HumanFactorManager& human, int op, int x, int y) {
+        human.findZonesCovering(x, y, found);
+        scanZonesCovering(human, x, y, scanned);
+        ++zone_queries;
+        if (found != scanned) {
+            return fail(op, "findZonesCovering(" + std::to_string(x) + ", " + std::to_string(y) + ") found " +
+                                std::to_string(found.size()) + " zones, a scan " + std::to_string(scanned.size()));
+        }
+        return true;
+    }
+
+    // A query around a crew (often hitting it exactly), then one anywhere
+    bool checkQueries(const HumanFactorManager& human, int op) {
+        const FirefightingCrew& crew = human.getCrews()[below(static_cast<int>(human.getCrews().size()))];
+        int radius = below(8) == 0 ? below(2000) : below(40);
+        if (!checkCrewQuery(human, op, crew.getX(), crew.getY(), radius)) return false;
+        if (!checkCrewQuery(human, op, coordinate(), coordinate(), below(120) - 1)) return false;
+        return checkZoneQuery(human, op, coordinate(), coordinate());
+    }
+
+    bool checkFindCrew(const HumanFactorManager& human, int op) {
+        for (const FirefightingCrew& crew : human.getCrews()) {
+            if (human.findCrew(crew.getId()) != &crew) {
+                return fail(op, "findCrew(" + std::to_string(crew.getId()) + ") is not the stored crew");
+            }
+        }
+        return true;
+    }
+
+public:
+    explicit IndexCheck(uint64_t seed) : rng(seed) {}
+
+    bool run(int ops) {
+        HumanFactorManager human;
+        for (int i = 0; i < 200; ++i) {
+            human.addCrew("Crew " + std::to_string(i), static_cast<CrewType>(below(4)), coordinate(), coordinate());
+        }
+        for (int i = 0; i < 60; ++i) {
+            human.addEvacuationZone("Zone " + std::to_string(i), coordinate(), coordinate(), below(60), 100);
+        }
+
+        HumanFactorManager assigned;
+        for (int op = 0; op < ops; ++op) {
+            int crew_count = static_cast<int>(human.getCrews().size());
+            FirefightingCrew& crew = human.getCrews()[below(crew_count)];
+            switch (below(10)) {
+                case 0:
+                case 1:
+                    human.deployCrewToLocation(crew.getId(), coordinate(), coordinate());
+                    break;
+                case 2:
+                    // Short hops mostly stay in the same bucket
+                    crew.moveTo(crew.getX() + below(9) - 4, crew.getY() + below(9) - 4);
+                    break;
+                case 3: {
+                    // Moving a copy must not move the stored crew in the index
+                    FirefightingCrew copy = crew;
+                    copy.moveTo(coordinate(), coordinate());
+                    ++copied_moves;
+                    if (!checkCrewQuery(human, op, copy.getX(), copy.getY(), 0) ||
+                        !checkCrewQuery(human, op, crew.getX(), crew.getY(), 0)) {
+                        return false;
+                    }
+                    break;
+                }
+                case 4:
+                    if (below(20) == 0) {
+                        human.addCrew("Late", CrewType::GROUND_CREW, coordinate(), coordinate());
+                    }
+                    break;
+                case 5:
+                    if (below(50) == 0) {
+                        human.addEvacuationZone("Late", coordinate(), coordinate(), below(60), 10);
+                    }
+                    break;
+                case 6:
+                    if (below(500) == 0) {
+                        // A copied manager indexes its own crews; moves on it
+                        // leave the original alone
+                        HumanFactorManager copy(human);
+                        for (int i = 0; i < 200; ++i) {
+                            FirefightingCrew& moved = copy.getCrews()[below(crew_count)];
+                            moved.moveTo(coordinate(), coordinate());
+                            if (!checkQueries(copy, op) || !checkQueries(human, op)) return false;
+                        }
+                        if (!checkFindCrew(copy, op)) return false;
+                        assigned = copy;
+                        for (int i = 0; i < 50; ++i) {
+                            assigned.getCrews()[below(crew_count)].moveTo(coordinate(), coordinate());
+                            if (!checkQueries(assigned, op)) return false;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (!checkQueries(human, op)) return false;
+        }
+        if (!checkFindCrew(human, ops)) return false;
+
+        std::printf("spatial_index_check: %d ops, %ld crew and %ld zone queries, %ld copied-crew moves\n", ops,
+                    crew_queries, zone_queries, copied_moves);
+        return true;
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    int ops = 20000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ops" && i + 1 < argc) {
+            ops = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--ops N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    IndexCheck check(seed);
+    if (!check.run(ops)) return 1;
+    std::printf("spatial_index_check: every query matches a linear scan: ok\n");
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Equivalence check for the update engines. ACTIVE_FRONT must match
+// FULL_SCAN bit for bit, at one thread and on a thread pool, for every
+// stencil, with suppression and firebreaks in the way. The running cell
+// counts must match a full recount after every step. Exits non-zero on the
+// first mismatch:
+//   update_engine_check [--steps N] [--threads N] [--seed N]
+#include "Grid.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+const int kWidth = 160;
+const int kHeight = 280;     // Several row bands, so band borders are crossed
+
+struct EngineRun {
+    const char* name;
+    UpdateMode mode;
+    bool pooled;
+};
+
+const char* stencilName(SpreadStencil stencil) {
+    switch (stencil) {
+        case SpreadStencil::MOORE_8: return "moore8";
+        case SpreadStencil::VON_NEUMANN_4: return "vonneumann4";
+        case SpreadStencil::EXTENDED_16: return "extended16";
+        case SpreadStencil::EXTENDED_24: return "extended24";
+    }
+    return "?";
+}
+
+// Mixed fuel from the seed, fires on and next to band borders, a firebreak
+// across the wind, and water and retardant drops near the fires
+void setupGrid(Grid& grid, uint64_t seed, SpreadStencil stencil) {
+    grid.setSeed(seed);
+    grid.initializeRandom();
+    grid.setWindSpeed(8.0);
+    grid.setWindDirection(60.0);
+    grid.setSpreadStencil(stencil);
+    grid.igniteCell(kWidth / 2, 63);
+    grid.igniteCell(kWidth / 2, 64);
+    grid.igniteCell(20, 200);
+    grid.igniteCell(kWidth - 1, kHeight - 1);
+    grid.createFirebreak(0, 100, kWidth - 40, 110);
+    grid.applyWaterDrop(kWidth / 2 + 6, 70, 4, 0.9, 12.0);
+    grid.applyRetardant(30, 190, 6, 0.7, 40.0);
+}
+
+// Drops while the fire is burning, some of them expiring during the run
+void suppressDuringRun(Grid& grid, int step) {
+    if (step == 20) grid.applyWaterDrop(kWidth / 2, 64, 5, 0.8, 3.0);
+    if (step == 45) grid.applyRetardant(24, 205, 3, 0.9, 7.5);
+    if (step == 60) grid.applyWaterDrop(kWidth / 2 - 10, 80, 8, 0.5, 30.0);
+}
+
+bool sameCell(const Grid& a, const Grid& b, int x, int y) {
+    Cell ca = a.getCell(x, y);
+    Cell cb = b.getCell(x, y);
+    SuppressionEffect sa = a.getSuppressionEffect(x, y);
+    SuppressionEffect sb = b.getSuppressionEffect(x, y);
+    return ca.getState() == cb.getState() && ca.getFuelType() == cb.getFuelType() &&
+           ca.getFuelDensity() == cb.getFuelDensity() && ca.getMoisture() == cb.getMoisture() &&
+           ca.getTemperature() == cb.getTemperature() && ca.getBurnTime() == cb.getBurnTime() &&
+           sa.water_level == sb.water_level && sa.retardant_level == sb.retardant_level &&
+           sa.remaining_time == sb.remaining_time && sa.is_firebreak == sb.is_firebreak;
+}
+
+bool checkCounts(const Grid& grid, const char* engine, const char* stencil, int step) {
+    int burning, burned, fuel;
+    grid.countCells(burning, burned, fuel);
+    if (burning == grid.getBurningCount() && burned == grid.getBurnedCount() && fuel == grid.getFuelCellCount()) {
+        return true;
+    }
+    std::fprintf(stderr,
+                 "update_engine_check: %s/%s step %d: counts %d/%d/%d, recount %d/%d/%d\n", engine, stencil,
+                 step, grid.getBurningCount(), grid.getBurnedCount(), grid.getFuelCellCount(), burning, burned,
+                 fuel);
+    return false;
+}
+
+bool checkStencil(SpreadStencil stencil, int steps, ThreadPool& pool, uint64_t seed) {
+    const EngineRun runs[] = {
+        {"full", UpdateMode::FULL_SCAN, false},
+        {"active", UpdateMode::ACTIVE_FRONT, false},
+        {"full-pooled", UpdateMode::FULL_SCAN, true},
+        {"active-pooled", UpdateMode::ACTIVE_FRONT, true},
+    };
+    const double dt = 0.5;
+
+    Grid reference(kWidth, kHeight);
+    setupGrid(reference, seed, stencil);
+    reference.setUpdateMode(UpdateMode::FULL_SCAN);
+
+    Grid active(kWidth, kHeight), full_pooled(kWidth, kHeight), active_pooled(kWidth, kHeight);
+    Grid* grids[3] = {&active, &full_pooled, &active_pooled};
+    for (int i = 0; i < 3; ++i) {
+        setupGrid(*grids[i], seed, stencil);
+        grids[i]->setUpdateMode(runs[i + 1].mode);
+        if (runs[i + 1].pooled) grids[i]->setThreadPool(&pool);
+    }
+
+    for (int step = 0; step < steps; ++step) {
+        suppressDuringRun(reference, step);
+        reference.update(dt);
+        if (!checkCounts(reference, runs[0].name, stencilName(stencil), step)) return false;
+
+        for (int i = 0; i < 3; ++i) {
+            Grid& grid = *grids[i];
+            suppressDuringRun(grid, step);
+            grid.update(dt);
+            if (!checkCounts(grid, runs[i + 1].name, stencilName(stencil), step)) return false;
+            // Cells are compared every few steps; a difference does not heal
+            if (step % 4 != 3 && step != steps - 1) continue;
+            for (int y = 0; y < kHeight; ++y) {
+                for (int x = 0; x < kWidth; ++x) {
+                    if (!sameCell(reference, grid, x, y)) {
+                        std::fprintf(stderr, "update_engine_check: %s/%s step %d: cell %d,%d differs from full\n",
+                                     runs[i + 1].name, stencilName(stencil), step, x, y);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    if (reference.getBurnedCount() == 0) {
+        std::fprintf(stderr, "update_engine_check: %s: the fire never burned out a cell\n", stencilName(stencil));
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int steps = 160;
+    int threads = 4;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--steps" && i + 1 < argc) {
+            steps = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--steps N] [--threads N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ThreadPool pool(threads);
+    for (SpreadStencil stencil : {SpreadStencil::MOORE_8, SpreadStencil::VON_NEUMANN_4,
+                                  SpreadStencil::EXTENDED_16, SpreadStencil::EXTENDED_24}) {
+        if (!checkStencil(stencil, steps, pool, seed)) return 1;
+    }
+
+    std::printf("update_engine_check: %d steps, 4 stencils, full and active at 1 and %d threads: ok\n", steps,
+                pool.getThreadCount());
+    return 0;
+}
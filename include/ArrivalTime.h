@@ -0,0 +1,96 @@
+#pragma once
+#include "Stencil.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Grid;
+
+// Deterministic answer to "when does the fire get here" for every cell, in
+// one pass instead of a stochastic run. A burning cell ignites a neighbour
+// with probability p * dt per step of dt seconds, i.e. at a rate of p per
+// second, with p the engines' own spread probability (ignition probability
+// of the target, wind and distance kernel, source temperature and
+// suppression; firebreaks block). A cell's ignition hazard is the sum of the
+// rates of its burning neighbours, each counted from the time it caught
+// fire, and its arrival time is the expected ignition time under that
+// hazard. Cells are settled in time order as in Dijkstra's algorithm; a
+// neighbour settled later than a cell's arrival time cannot change it.
+//
+// Burning cells start at time 0 with their current temperature; cells
+// reached later spread like freshly ignited ones. Burn-out is not modelled,
+// and the times are expectations along the fastest front, so they lag a
+// stochastic run, whose front is carried by its luckiest cells, in open
+// fuel. The grid is only read.
+//
+// Times only grow as cells are settled, so the queue is a radix heap over
+// the bit patterns of the (non-negative) times: pushes are O(1) and each
+// entry moves between buckets at most 64 times.
+class ArrivalTimeSolver {
+private:
+    static constexpr int kMaxEdges = Extended24::kSize;
+
+    class RadixHeap {
+    private:
+        std::vector<std::pair<uint64_t, int>> buckets[65];  // Bucket b: highest bit differing from last is b - 1
+        uint64_t last;          // Key last popped
+        size_t count;
+
+        static uint64_t keyBits(double key) {
+            uint64_t bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            return bits;
+        }
+        int bucketOf(uint64_t bits) const { return bits == last ? 0 : 64 - __builtin_clzll(bits ^ last); }
+
+    public:
+        RadixHeap() : last(0), count(0) {}
+        void clear();
+        bool empty() const { return count == 0; }
+        // key must not be below the key last popped
+        void push(double key, int value);
+        void pop(double& key, int& value);
+    };
+
+    int width, height;
+    std::vector<float> arrival_times;   // Seconds by y * width + x, kUnreached if never
+    int reached_count;                  // Cells with a finite time, sources included
+    double max_arrival_time;
+
+    // Ignition hazard of an unsettled cell from the neighbours settled so far
+    struct Hazard {
+        double rate;        // Summed spread rates, per second
+        double since;       // When rate last grew
+        double survival;    // Chance of not having ignited by then
+        double expected;    // First neighbour's time plus the survival integral up to since
+    };
+
+    // Scratch in the grid's padded layout
+    std::vector<double> times;
+    std::vector<double> receptivity;
+    std::vector<Hazard> hazards;
+    std::vector<uint8_t> settled;
+    RadixHeap heap;
+
+public:
+    static constexpr float kUnreached = std::numeric_limits<float>::infinity();
+
+    ArrivalTimeSolver();
+
+    void solve(const Grid& grid);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    float getArrivalTime(int x, int y) const { return arrival_times[y * width + x]; }
+    bool isReached(int x, int y) const { return getArrivalTime(x, y) != kUnreached; }
+    int getReachedCount() const { return reached_count; }
+    double getMaxArrivalTime() const { return max_arrival_time; }
+    // Cells reached at or before time, sources included
+    int countReachedBy(double time) const;
+
+    // Arrival times as an ESRI ASCII grid, first row = y 0, NODATA where unreached
+    bool saveRaster(const std::string& filename) const;
+};
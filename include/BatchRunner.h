@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Settings for a non-interactive run, filled from the command line
+struct BatchOptions {
+    std::string scenario = "grassland";     // grassland, forest, mixed, terrain or procedural
+    int width = 100;
+    int height = 100;
+    double wind_speed = 5.0;                // m/s
+    double wind_direction = 90.0;           // degrees
+    double temperature = 25.0;              // Celsius
+    double humidity = 0.4;                  // 0.0 to 1.0
+    std::vector<std::pair<int, int>> ignition_points; // Grid centre when empty
+    std::string stencil = "moore8";         // moore8, vonneumann4, extended16 or extended24
+    std::string engine = "active";          // active, full, bitplane or arrival
+    bool has_seed = false;
+    uint64_t seed = 0;
+    long max_steps = -1;                    // -1 for no step limit
+    double end_time = -1.0;                 // Simulated seconds, -1 for no limit
+    double time_step = 0.1;                 // Seconds per step
+    int threads = 1;
+    std::string output_path;                // Grid dump written at the end, if set
+    int ensemble_members = 0;               // > 0 runs a Monte Carlo ensemble instead
+    std::string burn_probability_path;      // Ensemble burn-probability raster, if set
+    std::string snapshot_out_path;          // Snapshot written at the end, if set
+    std::string restore_path;               // Snapshot to continue from instead of a scenario
+    std::string record_path;                // Frame stream written during the run, if set
+    int record_every = 10;                  // Steps between recorded frames
+    int watch_every = 0;                    // > 0 draws the grid on stderr every N steps
+    std::string arrival_out_path;           // Arrival-time raster of the arrival engine, if set
+    int ranks = 1;                          // > 1 splits the grid into subdomains, one process each
+    int tile_size = 0;                      // > 0 runs on a TiledGrid with tiles this many cells a side
+    std::string fuel_raster_path;           // Fuel type raster replacing the scenario, if set
+    std::string density_raster_path;        // Fuel density raster, if set (needs a fuel raster)
+    std::string moisture_raster_path;       // Moisture raster, if set (needs a fuel raster)
+};
+
+// Returns false and sets error when an argument is unknown or malformed
+bool parseBatchOptions(int argc, char* argv[], BatchOptions& options, std::string& error);
+void printBatchUsage(const char* program);
+
+// Runs the simulation (or the ensemble) without rendering or sleeping and
+// prints a one-line JSON summary to stdout. Returns the process exit code.
+int runBatch(const BatchOptions& options);
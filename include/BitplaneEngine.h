@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Grid;
+
+// Fast update for grids whose burnable cells all hold the same fuel and that
+// have no water or retardant on them. Every spread target then has the same
+// ignition probability, so spread is decided for 64 cells per word: fuel and
+// burning cells are bitplanes, and one bit-sliced draw per word and direction
+// picks the sources that fire. Cells that ignited on the same step share
+// their burn time and temperature, so burning cells are also grouped into
+// cohorts that advance through the burn kernel once per cohort.
+//
+// Spread uses the general engine's probabilities, but draws come from their
+// own random stream. A run is reproducible for a seed, but it differs cell by
+// cell from a run of the general engine with the same seed.
+class BitplaneEngine {
+private:
+    struct Cohort {
+        // State shared by every cell of the cohort, in Grid's field encoding
+        uint8_t state, fuel_type, fuel_density, moisture;
+        int16_t temperature;
+        float burn_time;
+        std::vector<int> words;         // Word index in the planes
+        std::vector<uint64_t> bits;     // Cells of the cohort in that word
+    };
+
+    bool attached;
+    bool blocked_by_suppression;    // Last attach failed on water or retardant
+    int width, height, row_words;   // Planes have row_words 64-bit words per row
+
+    // The uniform burnable fuel
+    uint8_t fuel_type, fuel_density, moisture;
+    double ignition_probability;
+
+    std::vector<uint64_t> fuel_plane;   // Cells that can still ignite
+    std::vector<uint64_t> burning_plane;
+    std::vector<int> row_burning;       // Burning cells per row, so idle rows are skipped
+    std::vector<uint64_t> ignite_plane; // Ignitions found this step
+    std::vector<int> ignite_words;      // Words of ignite_plane that are set
+    std::vector<Cohort> cohorts;
+    std::vector<Cohort> spare_cohorts;  // Burned-out cohorts kept for their capacity
+    std::vector<uint64_t> max_thresholds; // Largest draw threshold per direction
+    std::vector<size_t> cursors;        // Per cohort, next word to write through
+    std::vector<uint8_t> state_changed; // Per cohort, ignited or burned out this step
+
+    Cohort& newCohort();
+    void addBurning(const Cohort& cohort, bool burning);
+    uint64_t drawThreshold(const Grid& grid, int direction_x, int direction_y,
+                           int16_t temperature, double dt) const;
+    static uint64_t drawMask(uint64_t lanes, uint64_t threshold, uint64_t word_key, int direction);
+    void scatter(int word, uint64_t fired, int dx, int dy);
+    void writeCohorts(Grid& grid);
+
+public:
+    BitplaneEngine();
+
+    bool isAttached() const { return attached; }
+    bool isBlockedBySuppression() const { return blocked_by_suppression; }
+
+    // Builds the planes from the grid's cell arrays. Returns false, leaving the
+    // engine detached, if burnable fuel is mixed or any cell is suppressed.
+    bool attach(const Grid& grid);
+    void detach() { attached = false; }
+
+    // One Grid::update step. The grid's cell arrays and counts are kept exact.
+    void update(Grid& grid, double dt);
+};
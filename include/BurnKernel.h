@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+// A contiguous run of cells in Grid's field arrays
+struct BurnSpan {
+    uint8_t* states;            // CellState
+    const uint8_t* fuel_types;  // FuelType
+    uint8_t* fuel_densities;    // 0-255 maps to 0.0-1.0
+    const uint8_t* moistures;   // 0-255 maps to 0.0-1.0
+    int16_t* temperatures;      // Tenths of a degree Celsius
+    float* burn_times;          // Seconds
+    int count;
+};
+
+enum class BurnKernelIsa {
+    SCALAR,
+    SSE2,       // 4 cells per instruction
+    AVX2,       // 8 cells per instruction
+    AVX512      // 16 cells per instruction
+};
+
+// Advances every burning cell in the span by dt: burn time, temperature and
+// burnout, following Cell::update. Cells in any other state are left alone.
+// The arithmetic is float rather than double, and temperature is stored in
+// tenths, so it agrees with Cell::update to within 0.05 degrees plus float
+// rounding; burnout only differs when the burn time is within float rounding
+// of the burn duration. check/burn_kernel_check holds the kernels to this.
+// Uses the widest instruction set the CPU supports, picked on first use.
+// Returns the number of cells that burned out.
+int burnProgress(const BurnSpan& span, float dt);
+
+// Same computation with a specific instruction set; the scalar version is the
+// reference the vector versions must match bit for bit
+int burnProgress(const BurnSpan& span, float dt, BurnKernelIsa isa);
+
+BurnKernelIsa getBurnKernelIsa();
+bool isBurnKernelIsaSupported(BurnKernelIsa isa);
+const char* getBurnKernelIsaName(BurnKernelIsa isa);
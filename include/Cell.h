@@ -41,11 +41,13 @@ public:
     void setFuelDensity(double density) { fuel_density = density; }
     void setMoisture(double moisture_level) { moisture = moisture_level; }
     void setTemperature(double temp) { temperature = temp; }
+    void setBurnTime(double time) { burn_time = time; }
     
     // Fire simulation methods
     void ignite();
     void update(double dt);
     bool canBurn() const;
     double getIgnitionProbability() const;
-    char getDisplayChar() const;
+    char getDisplayChar() const { return getDisplayChar(state, fuel_type); }
+    static char getDisplayChar(CellState state, FuelType fuel_type);
 };
\ No newline at end of file
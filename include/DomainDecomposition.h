@@ -0,0 +1,103 @@
+#pragma once
+#include "Grid.h"
+#include "FuelLayer.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Rectangle of the landscape stepped by one rank
+struct Subdomain {
+    int x0, y0;
+    int width, height;
+};
+
+// What the ranks build their subdomains from: the static fuel, the settings
+// every subdomain shares and the cells burning at the start, in landscape
+// cells. Nothing here grows with the landscape unless the fuel is a RASTER.
+struct Landscape {
+    FuelLayer fuel;
+    uint64_t seed = 0;
+    double wind_speed = 5.0;                // m/s
+    double wind_direction = 90.0;           // degrees
+    double ambient_temp = 25.0;             // Celsius
+    double humidity = 0.4;                  // 0.0 to 1.0
+    SpreadStencil spread_stencil = SpreadStencil::MOORE_8;
+    UpdateMode update_mode = UpdateMode::ACTIVE_FRONT;
+    std::vector<std::pair<int, int>> ignition_points;
+};
+
+// Steps one grid as a layout of rectangular subdomains, each in its own
+// forked process (a "rank") with a Grid of its own. A rank allocates and
+// first touches all of its working memory, so on a NUMA machine it stays on
+// the node the rank runs on; the only shared pages are the small per-rank
+// halo strips below.
+//
+// Before every step each rank publishes the state and temperature of its
+// cells within Grid::kHalo of its edges to POSIX shared memory, then waits on
+// a process-shared barrier. It then copies the burning cells that border it
+// into its grid's halo sources. A fire crossing an edge is drawn by the rank
+// that owns the target cell, with the draws the source would use in one
+// grid, so the run matches a single-process run cell for cell. Strips are
+// double-buffered by step parity, which keeps it to one barrier per step.
+//
+// Each rank builds its own subdomain from the Landscape after the fork, the
+// way TiledGrid builds a tile, so no process ever holds the whole grid: the
+// coordinator only keeps the halo strips and the counts merged at the end.
+//
+// Only the fire is decomposed. Crews, evacuation zones and suppression are
+// not, and BITPLANE grids are stepped in ACTIVE_FRONT mode.
+class DomainDecomposition {
+private:
+    int columns, rows;
+    std::vector<int> x_bounds;      // Column c spans [x_bounds[c], x_bounds[c + 1])
+    std::vector<int> y_bounds;
+    double time_step;
+
+    // Results of the last run()
+    long steps;
+    double sim_time;
+    int cells_burning;
+    int cells_burned;
+    int total_fuel_cells;
+    std::vector<double> step_seconds;   // Per rank, inside Grid::update
+    std::vector<double> wait_seconds;   // Per rank, publishing, waiting and reading halos
+
+    struct SharedLayout;
+    SharedLayout sharedLayout() const;
+
+    // Position of a cell in its owner's halo strip: the kHalo rows at the top
+    // and bottom, then the kHalo columns at each side of the rows between
+    static int stripCells(const Subdomain& area);
+    static int stripOffset(const Subdomain& area, int x, int y);
+    int ownerOf(int x, int y) const;
+    void buildSubdomain(const Landscape& landscape, const Subdomain& area, Grid& grid) const;
+    void runRank(int rank, const Landscape& landscape, long max_steps, double end_time, char* shared) const;
+
+public:
+    explicit DomainDecomposition(double dt = 0.1);
+
+    // Picks the columns x rows layout of ranks subdomains that cuts the fewest
+    // cells. Fails when a subdomain would be narrower than 2 * Grid::kHalo.
+    bool partition(int width, int height, int ranks, std::string& error);
+    int getRankCount() const { return columns * rows; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    Subdomain getSubdomain(int rank) const;
+
+    // Steps landscape, whose fuel must match the partitioned size, until the
+    // fire burns out, max_steps steps have run or end_time simulated seconds
+    // have passed (-1 disables a limit), like FireSimulation::runHeadless.
+    // Returns false and sets error when shared memory or a rank fails.
+    bool run(const Landscape& landscape, long max_steps, double end_time, std::string& error);
+
+    // Results, merged over the ranks
+    long getSteps() const { return steps; }
+    double getSimTime() const { return sim_time; }
+    int getCellsBurning() const { return cells_burning; }
+    int getCellsBurned() const { return cells_burned; }
+    int getTotalFuelCells() const { return total_fuel_cells; }
+    double getBurnPercentage() const;
+    const std::vector<double>& getStepSeconds() const { return step_seconds; }
+    const std::vector<double>& getWaitSeconds() const { return wait_seconds; }
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "Grid.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs many stochastic realizations of one scenario and accumulates how often
+// each cell burned. Members differ only in their seed; every member starts
+// from the same initial grid, held once here and copied into a per-thread
+// working grid, so memory grows with the thread count, not the member count.
+// The terrain is read-only during a run, so it is copied once per thread;
+// each member after the first copies back only the fields a run changes
+// (see Grid::resetTo).
+class Ensemble {
+private:
+    Grid initial_grid;          // Read-only starting state shared by all members
+    double time_step;
+    std::unique_ptr<ThreadPool> thread_pool;
+    
+    // Results of the last run()
+    int member_count;
+    std::unique_ptr<std::atomic<uint32_t>[]> burn_counts; // Members in which each cell ignited
+    std::vector<double> burn_percentages;                  // getBurnPercentage() per member
+    std::vector<double> sorted_percentages;
+    
+public:
+    Ensemble(const Grid& initial, double dt = 0.1);
+    
+    void setThreadCount(int threads);
+    int getThreadCount() const { return thread_pool->getThreadCount(); }
+    
+    // Runs members [0, members) with seeds derived from seed. Each member stops
+    // when its fire burns out or at max_steps / end_time (-1 disables a limit).
+    // Results only depend on the seed, not on the thread count.
+    void run(int members, uint64_t seed, long max_steps = -1, double end_time = -1);
+    static uint64_t memberSeed(uint64_t seed, int member);
+    
+    // Results
+    const Grid& getInitialGrid() const { return initial_grid; }
+    int getMemberCount() const { return member_count; }
+    uint32_t getBurnCount(int x, int y) const;
+    double getBurnProbability(int x, int y) const;
+    const std::vector<double>& getBurnPercentages() const { return burn_percentages; }
+    double getMeanBurnPercentage() const;
+    double getBurnPercentageQuantile(double q) const; // q in [0, 1], linear interpolation
+    
+    // Burn probability per cell as an ESRI ASCII grid, first row = y 0
+    bool saveProbabilityRaster(const std::string& filename) const;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+// Linear radial falloff over the disk of cells within radius of a centre:
+// 1 - distance / radius, the shape water and retardant drops are laid down
+// with (1 everywhere for radius 0). Each row holds the factors for
+// dx in [-halfWidth(dy), halfWidth(dy)], so a stamp walks whole rows.
+class FalloffKernel {
+private:
+    int radius;
+    std::vector<int> half_widths;   // Per row, dy = -radius first
+    std::vector<int> row_centers;   // Index in factors of dx = 0, per row
+    std::vector<double> factors;
+
+public:
+    explicit FalloffKernel(int kernel_radius);
+
+    int getRadius() const { return radius; }
+    int halfWidth(int dy) const { return half_widths[dy + radius]; }
+    // Indexed by dx in [-halfWidth(dy), halfWidth(dy)]
+    const double* row(int dy) const { return factors.data() + row_centers[dy + radius]; }
+};
+
+// Kernels by radius, built on first use and shared by copies of the cache
+class FalloffKernelCache {
+private:
+    std::vector<std::shared_ptr<const FalloffKernel>> kernels;
+
+public:
+    // radius must be non-negative
+    const FalloffKernel& get(int radius);
+};
@@ -1,12 +1,19 @@
 #pragma once
 #include "Grid.h"
 #include "FirefightingCrew.h"
+#include "FrameRecorder.h"
+#include "SuppressionQueue.h"
+#include "ThreadPool.h"
 #include <chrono>
+#include <memory>
 
 class FireSimulation {
 private:
     Grid grid;
     HumanFactorManager human_manager;
+    SuppressionQueue suppression_queue;     // Filled by orderSuppression, drained by step
+    std::unique_ptr<ThreadPool> thread_pool;
+    std::unique_ptr<FrameRecorder> recorder;    // Last recording, null if there was none
     double time_step;           // Simulation time step in seconds
     double total_time;          // Total simulation time elapsed
     bool running;
@@ -16,6 +23,8 @@ private:
     int cells_burned;
     int total_fuel_cells;
     
+    friend class SnapshotIO;
+    
 public:
     FireSimulation(int width, int height, double dt = 0.1);
     
@@ -25,12 +34,26 @@ public:
     void reset();
     void step();
     void run(double duration = -1); // -1 for indefinite
+    // Steps without rendering or sleeping until the fire burns out, max_steps
+    // steps have run or end_time simulated seconds have passed (-1 disables a
+    // limit). Returns the number of steps taken.
+    long runHeadless(long max_steps, double end_time = -1);
+    void setThreadCount(int threads);
+    // Replaces the grid with a copy of initial (same size reuses the storage) and resets the clock
+    void loadGrid(const Grid& initial);
+    // loadGrid for a grid already loaded from initial, or from a grid with
+    // the same terrain: copies back only what a run changes
+    void reloadGrid(const Grid& initial);
+    void setSeed(uint64_t seed) { grid.setSeed(seed); }
+    uint64_t getSeed() const { return grid.getSeed(); }
+    int getThreadCount() const { return thread_pool->getThreadCount(); }
     
     // Getters
     Grid& getGrid() { return grid; }
     const Grid& getGrid() const { return grid; }
     HumanFactorManager& getHumanManager() { return human_manager; }
     const HumanFactorManager& getHumanManager() const { return human_manager; }
+    SuppressionQueue& getSuppressionQueue() { return suppression_queue; }
     double getTotalTime() const { return total_time; }
     bool isRunning() const { return running; }
     
@@ -45,10 +68,21 @@ public:
     void setupGrassland();
     void setupForest();
     void setupMixed();
+    void setupProcedural();
     void addFirebreak(int x1, int y1, int x2, int y2);
     void addIgnitionPoint(int x, int y);
     
     // Display and output
-    void printStatus() const;
-    void saveToFile(const std::string& filename) const;
+    void printStatus(std::ostream& out = std::cout) const;
+    bool saveToFile(const std::string& filename) const;
+    // Binary snapshot of the whole simulation (see Snapshot.h). loadSnapshot
+    // replaces the grid, clock, crews and zones; on failure nothing changes.
+    bool saveSnapshot(const std::string& path, std::string& error) const;
+    bool loadSnapshot(const std::string& path, std::string& error);
+    // Streams every every_steps-th step to a delta-encoded frame file (see
+    // FrameRecorder.h), starting with the current state. The stopped recorder
+    // stays readable through getRecorder until the next recording starts.
+    bool startRecording(const std::string& path, int every_steps, int keyframe_every, std::string& error);
+    bool stopRecording(std::string& error);
+    const FrameRecorder* getRecorder() const { return recorder.get(); }
 };
\ No newline at end of file
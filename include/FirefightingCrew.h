@@ -1,7 +1,14 @@
 #pragma once
+#include "SpatialHash.h"
+#include "ZoneDanger.h"
+#include <iostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+class HumanFactorManager;
+class SuppressionQueue;
+
 enum class CrewType {
     GROUND_CREW,    // Manual firefighting, firebreaks
     WATER_TANKER,   // Water drops
@@ -19,6 +26,7 @@ enum class SuppressionType {
 struct SuppressionAction {
     SuppressionType type;
     int x, y;           // Target coordinates
+    int end_x, end_y;   // Far end of a firebreak line
     int radius;         // Effect radius
     double effectiveness; // 0.0 to 1.0
     double duration;    // How long the effect lasts
@@ -39,6 +47,12 @@ private:
     double fatigue;        // 0.0 (fresh) to 1.0 (exhausted)
     bool available;        // Can take new assignments
     double speed;          // Movement speed (cells per time unit)
+    // Told about moves to keep its index current; may be null. A copy keeps
+    // it, but only moves of the crew the manager stores are indexed.
+    HumanFactorManager* manager;
+    
+    friend class SnapshotIO;
+    friend class HumanFactorManager;
     
 public:
     FirefightingCrew(int crew_id, const std::string& crew_name, CrewType crew_type, 
@@ -55,6 +69,7 @@ public:
     double getEffectiveness() const { return effectiveness * (1.0 - fatigue); }
     double getFatigue() const { return fatigue; }
     bool isAvailable() const { return available; }
+    char getDisplayChar() const;
     
     // Operations
     void moveTo(int target_x, int target_y);
@@ -89,8 +104,32 @@ private:
     double spent_budget;    // Resources used
     int next_crew_id;
     
+    // Indexes over crews and zones. Crews are only ever appended, so a slot
+    // (index into crews) stays valid; the spatial hashes hold slots and zone
+    // indices. Crews report their own moves, so the crew hash follows
+    // FirefightingCrew::moveTo. Zones are indexed by their bounding box.
+    std::unordered_map<int, int> crew_slots;    // Crew id -> slot
+    SpatialHash crew_positions;
+    SpatialHash zone_areas;
+    ZoneDangerTracker zone_danger;
+    SuppressionQueue* suppression_queue;    // Not owned; receives ordered actions, may be null
+    
+    void rebuildIndexes();
+    void onCrewMoved(const FirefightingCrew& crew, int old_x, int old_y);
+    
+    friend class SnapshotIO;
+    friend class FirefightingCrew;
+    
 public:
     HumanFactorManager(double initial_budget = 100000.0);
+    // Copies point their crews at the copy and rebuild the indexes; zone
+    // danger is recounted on the copy's next updateDanger. The suppression
+    // queue belongs to the owner: a copy has none, an assignment keeps its own.
+    HumanFactorManager(const HumanFactorManager& other);
+    HumanFactorManager& operator=(const HumanFactorManager& other);
+    
+    // Where successful orderSuppression actions go to be applied to the grid
+    void setSuppressionQueue(SuppressionQueue* queue) { suppression_queue = queue; }
     
     // Crew management
     void addCrew(const std::string& name, CrewType type, int x, int y);
@@ -103,15 +142,30 @@ public:
     void addEvacuationZone(const std::string& name, int x, int y, int radius, int population);
     void orderEvacuation(int zone_index);
     void updateEvacuations(double dt);
+    // Refreshes every zone's danger_level from the grid's change log
+    void updateDanger(const Grid& grid);
+    // Call after the grid is replaced, so danger is recounted from scratch
+    void invalidateDanger() { zone_danger.invalidate(); }
     
     // Resource management
     bool canAfford(double cost) const;
     void spendBudget(double amount);
     double getRemainingBudget() const { return total_budget - spent_budget; }
     
-    // Status and display
+    // Lookups that cost O(result) rather than O(fleet). Crews are found by
+    // id, by a circle of cells around (x, y) (ids in fleet order) or zones by
+    // a cell inside their circle (zone indices in order).
+    FirefightingCrew* findCrew(int crew_id);
+    const FirefightingCrew* findCrew(int crew_id) const;
+    void findCrewsWithin(int x, int y, int radius, std::vector<int>& crew_ids) const;
+    void findZonesCovering(int x, int y, std::vector<int>& zone_indices) const;
+    
+    // Status and display. Crews and zones must be added through addCrew and
+    // addEvacuationZone, and zones must not be moved, for the indexes to hold.
     std::vector<FirefightingCrew>& getCrews() { return crews; }
+    const std::vector<FirefightingCrew>& getCrews() const { return crews; }
     std::vector<EvacuationZone>& getEvacuationZones() { return evacuation_zones; }
-    void printStatus() const;
+    const std::vector<EvacuationZone>& getEvacuationZones() const { return evacuation_zones; }
+    void printStatus(std::ostream& out = std::cout) const;
     char getCrewDisplayChar(int x, int y) const;
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Grid;
+class HumanFactorManager;
+
+// Frame cell codes: one byte per cell, row-major without the ghost border
+constexpr uint8_t kFrameStateMask = 0x03;   // CellState
+constexpr uint8_t kFrameWater = 0x04;       // Water level above zero
+constexpr uint8_t kFrameRetardant = 0x08;   // Retardant level above zero
+constexpr uint8_t kFrameFirebreak = 0x10;
+constexpr uint8_t kFrameCrew = 0x20;        // A crew stands on the cell
+
+// Frame stream file layout (native byte order):
+//   header   "WFFRAME\n", version, width, height, keyframe interval, record interval
+//   frames   type (key or delta), grid step, simulated time, payload size, payload
+// A keyframe payload is (varint run length, code) pairs covering the whole
+// grid. A delta payload is (varint unchanged cells skipped, varint run length,
+// code) triples against the previous frame in the file. Every
+// keyframe_interval-th frame is a keyframe, so a reader can seek without
+// decoding from the start.
+constexpr uint32_t kFrameStreamVersion = 1;
+constexpr int kDefaultKeyframeInterval = 32;
+
+// Records every record_interval-th step. The stepping thread only copies the
+// cell codes into a recycled buffer; diffing, encoding and writing happen on
+// a dedicated writer thread. The queue between them is bounded: when the
+// writer falls behind, the stepping thread waits for it rather than dropping
+// a frame, so every due step reaches the file. Only a grid of another size
+// than the recording is dropped.
+class FrameRecorder {
+private:
+    struct PendingFrame {
+        std::vector<uint8_t> codes;
+        uint32_t step;
+        double time;
+    };
+
+    int width, height;
+    int record_interval;
+    int keyframe_interval;
+    size_t max_queued;
+    long steps_seen;            // Stepping thread only
+
+    // Shared with the writer thread, guarded by mutex
+    mutable std::mutex mutex;
+    std::condition_variable frame_ready;
+    std::condition_variable frame_taken;    // The writer made room in the queue
+    std::deque<PendingFrame> queue;
+    std::vector<std::vector<uint8_t>> free_buffers;
+    bool stopping;
+    long frames_written;
+    long frames_dropped;
+    long frames_stalled;        // Captures that waited for room in the queue
+    std::string write_error;
+
+    // Writer thread only
+    std::ofstream file;
+    std::vector<uint8_t> previous;
+    std::vector<uint8_t> payload;
+    std::thread writer;
+
+    void writerLoop();
+    void writeFrame(const PendingFrame& frame, bool keyframe);
+
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Creates the file, writes the header and starts the writer thread.
+    // Returns false and sets error if the file cannot be created.
+    bool open(const std::string& path, int grid_width, int grid_height, int every_steps,
+              int keyframe_every, std::string& error);
+    // Writes the queued frames and stops the writer. Returns false and sets
+    // error if any write failed.
+    bool close(std::string& error);
+    bool isOpen() const { return writer.joinable(); }
+
+    // Called after every step; captures the frame when the step is due. A
+    // grid of another size than the recording is not captured.
+    void onStep(const Grid& grid, const HumanFactorManager& human, double time);
+    void capture(const Grid& grid, const HumanFactorManager& human, double time);
+
+    long getFramesWritten() const;
+    long getFramesDropped() const;
+    long getFramesStalled() const;
+};
+
+// Random access to a recorded frame stream. open() indexes the frame headers
+// without decoding payloads; a frame cut short by a crash ends the stream.
+class FrameReader {
+private:
+    struct FrameEntry {
+        uint64_t payload_offset;
+        uint32_t payload_bytes;
+        uint32_t step;
+        double time;
+        bool keyframe;
+    };
+
+    std::ifstream file;
+    int width, height;
+    int record_interval, keyframe_interval;
+    std::vector<FrameEntry> frames;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> current;   // Last decoded frame, so playback only applies one delta
+    int current_frame;              // -1 when current holds nothing
+
+    bool applyFrame(const FrameEntry& entry, std::string& error);
+
+public:
+    FrameReader();
+
+    bool open(const std::string& path, std::string& error);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getRecordInterval() const { return record_interval; }
+    int getFrameCount() const { return static_cast<int>(frames.size()); }
+    uint32_t getFrameStep(int frame) const { return frames[frame].step; }
+    double getFrameTime(int frame) const { return frames[frame].time; }
+
+    // Decodes frame into codes (width * height cell codes), starting from the
+    // closest keyframe at or before it
+    bool seek(int frame, std::vector<uint8_t>& codes, std::string& error);
+};
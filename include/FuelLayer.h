@@ -0,0 +1,64 @@
+#pragma once
+#include "Cell.h"
+#include "ProceduralTerrain.h"
+#include "Random.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Grid;
+
+// Static fuel of a landscape: the unburned Cell at every position, before
+// any fire, suppression or firebreak. Only RASTER layers store anything per
+// cell; the others compute a cell from its position, so a TiledGrid can
+// leave the tiles fire never reaches unallocated and read them from here.
+class FuelLayer {
+public:
+    enum class Kind {
+        UNIFORM,    // One cell everywhere
+        RANDOM,     // Grid::initializeRandom, keyed by landscape cell
+        TERRAIN,    // Grid::initializeTerrain
+        RASTER,     // Fuel type, density and moisture per cell, captured or imported
+        PROCEDURAL  // ProceduralTerrain noise
+    };
+
+private:
+    Kind kind;
+    int width, height;
+    Cell uniform_cell;
+    CounterRng rng;
+    ProceduralTerrain noise;
+    // RASTER only, y * width + x, encoded like the Grid fields
+    std::vector<uint8_t> fuel_types;
+    std::vector<uint8_t> fuel_densities;
+    std::vector<uint8_t> moistures;
+
+    FuelLayer(Kind kind, int w, int h);
+
+    friend class RasterImport;
+
+public:
+    // An empty 0 x 0 layer, to be assigned or filled by RasterImport::load
+    FuelLayer();
+
+    static FuelLayer uniform(int w, int h, const Cell& cell);
+    static FuelLayer random(int w, int h, uint64_t seed);
+    static FuelLayer terrain(int w, int h);
+    static FuelLayer procedural(int w, int h, uint64_t seed,
+                                int feature_size = ProceduralTerrain::kDefaultFeatureSize);
+    // Fuel type, density and moisture of every cell of grid; states,
+    // temperatures and suppression are not kept
+    static FuelLayer capture(const Grid& grid);
+
+    // The rules behind Grid::initializeRandom and Grid::initializeTerrain
+    static Cell randomCell(const CounterRng& rng, uint64_t cell);
+    static Cell terrainCell(int x, int y, int width, int height);
+
+    Kind getKind() const { return kind; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    Cell getCell(int x, int y) const;
+    // Sets every cell of grid to the layer's cells from (x0, y0) on
+    void fill(Grid& grid, int x0, int y0) const;
+    size_t getBytes() const;
+};
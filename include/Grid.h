@@ -1,5 +1,14 @@
 #pragma once
 #include "Cell.h"
+#include "Random.h"
+#include "Stencil.h"
+#include "BitplaneEngine.h"
+#include "FalloffKernel.h"
+#include "TimerWheel.h"
+#include "ProceduralTerrain.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 struct SuppressionEffect {
@@ -9,52 +18,293 @@ struct SuppressionEffect {
     bool is_firebreak;      // Permanent barrier
 };
 
+// One water or retardant drop for Grid::applyDrops
+struct SuppressionDrop {
+    bool retardant;
+    int x, y, radius;
+    double effectiveness;   // 0.0 to 1.0 at the centre
+    double duration;        // Seconds; 0 or less never wears off
+};
+
+class ThreadPool;
+
+enum class UpdateMode {
+    FULL_SCAN,      // Visit every cell on every step (reference implementation, O(cells) per step)
+    ACTIVE_FRONT,   // Visit only burning and igniting cells, and suppression that ends this step
+    BITPLANE        // BitplaneEngine while the fuel is uniform and unsuppressed, else ACTIVE_FRONT
+};
+
 class Grid {
 private:
     int width, height;
-    std::vector<std::vector<Cell>> cells;
-    std::vector<std::vector<SuppressionEffect>> suppression_effects;
+
+    // A ring of kHalo ghost cells surrounds the grid. Ghosts stay EMPTY, so a
+    // stencil can be applied to any cell without checking the grid bounds.
+    static constexpr int kHalo = kMaxStencilRadius;
+    int stride;             // width + 2 * kHalo
+
+    // Cell fields, one contiguous array per field (index = (y + kHalo) * stride + x + kHalo)
+    std::vector<uint8_t> states;          // CellState
+    std::vector<uint8_t> fuel_types;      // FuelType
+    std::vector<uint8_t> fuel_densities;  // 0-255 maps to 0.0-1.0
+    std::vector<uint8_t> moistures;       // 0-255 maps to 0.0-1.0
+    std::vector<int16_t> temperatures;    // Tenths of a degree Celsius
+    static constexpr int16_t kIgnitionTemperature = 3000;  // Set by igniteAt, 300 C
+    std::vector<float> burn_times;        // Seconds
+    std::vector<uint16_t> ignition_probabilities; // Cached Cell::getIgnitionProbability of fuel cells
+
+    // Suppression effect fields, same layout as the cell fields
+    std::vector<uint8_t> water_levels;     // 0-255 maps to 0.0-1.0
+    std::vector<uint8_t> retardant_levels; // 0-255 maps to 0.0-1.0
+    // Clock time the effect wears off, only for cells whose effect does; few
+    // cells are suppressed at a time, so this is not a per-cell array
+    std::unordered_map<int, double> suppression_ends;
+    std::vector<uint8_t> firebreaks;       // Permanent barrier flag
+
     double wind_speed;      // m/s
     double wind_direction;  // degrees (0 = north, 90 = east)
     double ambient_temp;    // Celsius
     double humidity;        // 0.0 to 1.0
+    SpreadStencil spread_stencil;
+    double spread_kernel[25];   // Wind and distance multiplier per neighbour offset, (dy+2)*5 + (dx+2)
+
+    // Active-front bookkeeping, kept sorted by index after every update
+    UpdateMode update_mode;
+    std::vector<int> burning_cells;       // Cells that are (or may be) burning
+    FalloffKernelCache falloff_kernels;   // Drop footprints by radius
+    std::vector<uint8_t> fold_water, fold_retardant;   // Scratch for applyDrops, one box of cells
+    std::vector<double> fold_ends;
+    
+    // Suppression wears off on a timer wheel keyed by the clock, so a step
+    // only visits the cells whose effect ends in it. Burnout is not on the
+    // wheel: every burning cell is visited each step to spread anyway, and
+    // the burn kernel advances it in the same visit. That keeps an
+    // ACTIVE_FRONT step at O(burning + igniting + expiring) cells; FULL_SCAN
+    // still sweeps every cell as the reference.
+    double clock;                         // Simulated seconds passed through update()
+    static constexpr double kClockSlack = 1e-9;
+    TimerWheel suppression_expiries;      // Cell index per suppression_ends entry
+    bool cell_lists_dirty;                // Lists were appended to outside update()
+    std::vector<uint64_t> ignite_bits;    // Pending ignitions, one bit per cell
+    std::vector<int> ignite_list;         // Cells with their bit set
+    std::vector<int> touched_cells;
+
+    // Bitplane mode state. The engine owns the fire while attached; it is
+    // detached whenever cells or suppression change from outside update().
+    BitplaneEngine bitplane;
+    bool bitplane_check_pending;          // Try to attach before the next step
+    bool burning_list_stale;              // The engine ran, burning_cells must be rebuilt
+    bool had_suppressed;                  // A suppression timer was live after the last step
+
+    // Cells that may have entered or left BURNING/BURNED, for observers
+    bool change_log_enabled;
+    std::vector<int> changed_cells;
+
+    // Running cell counts, updated on every state change
+    int burning_count;      // BURNING cells
+    int burned_count;       // BURNED cells
+    int fuel_count;         // Cells that can burn, are burning or have burned
     
+    // Random draws are keyed by (seed, step, cell, direction)
+    CounterRng rng;
+    uint32_t step_count;
+
+    // Where the grid sits in the landscape when it is one tile or subdomain
+    // of it (see TiledGrid and DomainDecomposition). Random draws are keyed
+    // by landscape cell.
+    int origin_x, origin_y;
+    int landscape_width;
+    
+    // Burning cells of neighbouring subdomains close enough to spread into
+    // this grid, at their position relative to it (see DomainDecomposition.h)
+    struct HaloSource {
+        int x, y;
+        int16_t temperature;
+    };
+    std::vector<HaloSource> halo_sources;
+    
+    // Both update passes work on bands of whole rows that run in parallel
+    static constexpr int kBandRows = 64;
+    struct Band {
+        int first, last;                // Slice of the cell list being processed
+        std::vector<int> ignitions;     // Cells this band's fires will ignite
+        std::vector<int> burning;       // Cells left burning by this band
+        int ignited;                    // FUEL -> BURNING transitions this step
+        int burned_out;                 // BURNING -> BURNED transitions this step
+    };
+    std::vector<Band> bands;
+    ThreadPool* thread_pool;            // Not owned; null runs bands on the caller
+
+    int index(int x, int y) const { return (y + kHalo) * stride + x + kHalo; }
+    int xOf(int idx) const { return idx % stride - kHalo; }
+    int yOf(int idx) const { return idx / stride - kHalo; }
+    // Random draws are keyed by the landscape's y * width + x, independent of
+    // the halo; 64-bit so no two cells of a large landscape share draws
+    uint64_t logicalIndexAt(int x, int y) const {
+        return static_cast<uint64_t>(y + origin_y) * static_cast<uint64_t>(landscape_width) +
+               static_cast<uint64_t>(x + origin_x);
+    }
+    uint64_t logicalIndex(int idx) const { return logicalIndexAt(xOf(idx), yOf(idx)); }
+    Cell loadCell(int idx) const;
+    void storeCell(int idx, const Cell& cell);
+    bool canBurnAt(int idx) const;
+    void countCell(int idx, int delta);
+    double suppressionModifierAt(int idx) const;
+    double ignitionProbabilityAt(int idx) const;
+    void refreshIgnitionProbability(int idx);
+    double windDistanceFactor(int dx, int dy) const;
+    void rebuildSpreadKernel();
+    double spreadProbability(double ignition, double kernel, int16_t source_temperature,
+                             double suppression) const;
+    double sourceHeatFactor(int16_t source_temperature) const;
+    double spreadProbabilityAt(int from_idx, int to_idx, double kernel) const;
+    template <typename Stencil, typename MarkFn>
+    void spreadFrom(int idx, double dt, MarkFn&& mark) const;
+    template <typename MarkFn>
+    void spreadFromCell(int idx, double dt, MarkFn&& mark) const;
+    template <typename Stencil>
+    void spreadFromHalo(double dt);
+    void spreadFromHaloSources(double dt);
+    bool igniteAt(int idx);
+    int advanceBurning(int begin, int end, double dt);
+    int advanceBurning(const std::vector<int>& sorted_cells, int first, int last, double dt);
+    void expireSuppression();
+    bool extinguishAt(int idx, double dt);
+    void stampFalloff(std::vector<uint8_t>& levels, int x, int y, int radius, double effectiveness,
+                      double duration);
+    void raiseSuppressionEnd(int idx, double end);
+    void foldDrops(const std::vector<SuppressionDrop>& drops, const std::vector<int>& members, int x0, int y0,
+                   int x1, int y1);
+    void prepareBands(const std::vector<int>& sorted_cells);
+    template <typename Task>
+    void forEachBand(const Task& task);
+    bool isIgnitionPending(int idx) const { return (ignite_bits[idx >> 6] >> (idx & 63)) & 1; }
+    void markIgnition(int idx) {
+        uint64_t bit = uint64_t(1) << (idx & 63);
+        if (!(ignite_bits[idx >> 6] & bit)) {
+            ignite_bits[idx >> 6] |= bit;
+            ignite_list.push_back(idx);
+        }
+    }
+    void collectIgnitions();
+    template <typename Fn>
+    void forEachPendingIgnition(int begin, int end, Fn&& fn) const;
+    void clearIgnitions();
+    void collectBandLists();
+    void updateFullScan(double dt);
+    void updateActiveFront(double dt);
+    bool updateBitplane(double dt);
+    void invalidateBitplane();
+    void normalizeCellLists();
+    void rebuildDerivedState();
+    void logChangedCells(const std::vector<int>& cells);
+
+    friend class BitplaneEngine;
+    friend class SnapshotIO;
+    friend class FrameRecorder;
+    friend class ArrivalTimeSolver;
+    friend class DomainDecomposition;
+    friend class FuelLayer;
+    friend class TiledGrid;
+
 public:
+    // w x h must satisfy fitsIndex
     Grid(int w, int h);
-    
+
+    // Whether a w x h grid and its halo can be addressed by int cell indices.
+    // Larger landscapes need TiledGrid or DomainDecomposition.
+    static bool fitsIndex(int w, int h) {
+        return (static_cast<int64_t>(w) + 2 * kHalo) * (static_cast<int64_t>(h) + 2 * kHalo) <= INT32_MAX;
+    }
+
     // Getters
     int getWidth() const { return width; }
     int getHeight() const { return height; }
-    Cell& getCell(int x, int y) { return cells[y][x]; }
-    const Cell& getCell(int x, int y) const { return cells[y][x]; }
+    Cell getCell(int x, int y) const { return loadCell(index(x, y)); }
+    CellState getCellState(int x, int y) const { return static_cast<CellState>(states[index(x, y)]); }
+    SuppressionEffect getSuppressionEffect(int x, int y) const;
+    // Character for the cell in text displays, suppression shown over the fuel
+    char getDisplayChar(int x, int y) const;
     double getWindSpeed() const { return wind_speed; }
     double getWindDirection() const { return wind_direction; }
     double getAmbientTemp() const { return ambient_temp; }
     double getHumidity() const { return humidity; }
-    
+
     // Setters
-    void setWindSpeed(double speed) { wind_speed = speed; }
-    void setWindDirection(double direction) { wind_direction = direction; }
+    void setCell(int x, int y, const Cell& cell);
+    void setWindSpeed(double speed);
+    void setWindDirection(double direction);
     void setAmbientTemp(double temp) { ambient_temp = temp; }
     void setHumidity(double humid) { humidity = humid; }
-    
+    void setSpreadStencil(SpreadStencil stencil) { spread_stencil = stencil; }
+    SpreadStencil getSpreadStencil() const { return spread_stencil; }
+
     // Grid operations
     bool isValidPosition(int x, int y) const;
     void initializeRandom();
     void initializeTerrain();
+    // ProceduralTerrain from the grid's seed, in bands on the thread pool
+    void initializeProcedural(int feature_size = ProceduralTerrain::kDefaultFeatureSize);
     void igniteCell(int x, int y);
     void display() const;
-    
+    // Returns to initial, a grid of the same size and terrain (fuel types and
+    // moistures) that this one was copied from. Only the fields a run writes
+    // are copied, so restarting from a template skips the terrain.
+    void resetTo(const Grid& initial);
+
     // Fire spread simulation
+    void setSeed(uint64_t seed) { rng.setSeed(seed); }
+    uint64_t getSeed() const { return rng.getSeed(); }
+    uint32_t getStepCount() const { return step_count; }
+    double getClock() const { return clock; }
+    void setUpdateMode(UpdateMode mode);
+    void setThreadPool(ThreadPool* pool) { thread_pool = pool; }
+    UpdateMode getUpdateMode() const { return update_mode; }
+    // True while BITPLANE mode is running on the bitplane engine rather than the fallback
+    bool isBitplaneActive() const { return bitplane.isAttached(); }
     void update(double dt);
     double calculateSpreadProbability(int from_x, int from_y, int to_x, int to_y) const;
     std::vector<std::pair<int, int>> getNeighbors(int x, int y) const;
-    
+    // Calls fn(nx, ny) for each in-bounds neighbour, without allocating
+    template <typename Stencil, typename Fn>
+    void forEachNeighbor(int x, int y, Fn&& fn) const {
+        for (const StencilOffset& offset : Stencil::kOffsets) {
+            if (isValidPosition(x + offset.dx, y + offset.dy)) {
+                fn(x + offset.dx, y + offset.dy);
+            }
+        }
+    }
+
     // Suppression methods
     void applyWaterDrop(int x, int y, int radius, double effectiveness, double duration);
     void applyRetardant(int x, int y, int radius, double effectiveness, double duration);
+    // Same result as applying the drops one by one, but drops that overlap
+    // are folded together first and their cells written once
+    void applyDrops(const std::vector<SuppressionDrop>& drops);
     void createFirebreak(int x1, int y1, int x2, int y2);
     void displayWithCrews(const class HumanFactorManager& human_manager) const;
     bool hasSuppressionEffect(int x, int y) const;
     double getSuppressionModifier(int x, int y) const;
-};
\ No newline at end of file
+
+    // Change log for observers of a few cells. While enabled, each step adds
+    // every cell that was burning or was ignited, and setCell adds cells it
+    // moves into or out of BURNING/BURNED. Entries may repeat or be
+    // unchanged; the observer compares against what it saw before. The log
+    // grows until clearChangedCells.
+    void setChangeLogEnabled(bool enabled);
+    template <typename Fn>
+    void forEachChangedCell(Fn&& fn) const {
+        for (int idx : changed_cells) fn(xOf(idx), yOf(idx), static_cast<CellState>(states[idx]));
+    }
+    void clearChangedCells() { changed_cells.clear(); }
+
+    // Cell counts, kept incrementally so reading them is O(1)
+    int getBurningCount() const { return burning_count; }
+    int getBurnedCount() const { return burned_count; }
+    int getFuelCellCount() const { return fuel_count; }
+    // Recounts from scratch; used to check the running counts
+    void countCells(int& burning, int& burned, int& fuel) const;
+    
+    // Memory footprint of the per-cell arrays
+    size_t getBytesPerCell() const;
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Read-only mapping of a whole file, unmapped on destruction. Pages are read
+// on first touch, so threads working on different parts of a large file
+// fault them in concurrently.
+class MappedFile {
+private:
+    void* address;
+    uint64_t length;
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file cannot be opened, is empty or cannot be mapped
+    bool open(const std::string& path);
+
+    const char* data() const { return static_cast<const char*>(address); }
+    uint64_t size() const { return length; }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "Cell.h"
+#include "Random.h"
+#include <cstddef>
+#include <cstdint>
+
+// Landscape from fractal value noise: random values on a lattice, smoothly
+// interpolated and summed over octaves of halving spacing. One noise field is
+// elevation (lakes in the hollows, bare rock on the ridges, drier fuel higher
+// up); a second is vegetation (grass, then shrub, then tree as it rises, and
+// denser fuel with it).
+//
+// Lattice values are counter-based draws keyed by the seed, field, octave and
+// lattice point, so each cell is a pure function of its position. Any block
+// can be generated on its own, on any thread and in any order, and comes out
+// the same.
+class ProceduralTerrain {
+public:
+    static constexpr int kDefaultFeatureSize = 64;  // Cells between base lattice points
+    static constexpr int kOctaves = 5;
+    // Finest lattice spacing is at least a cell, which bounds the lattice
+    // points one generate() tile needs
+    static constexpr int kMinFeatureSize = 1 << (kOctaves - 1);
+    static constexpr int kTileSize = 64;            // Cells a side that generate() works in
+
+private:
+    CounterRng rng;
+    int feature_size;
+
+    // Value in [0, 1) at one lattice point
+    double latticeValue(int field, int octave, int64_t ix, int64_t iy) const;
+
+public:
+    explicit ProceduralTerrain(uint64_t seed = 0, int feature_size = kDefaultFeatureSize);
+
+    uint64_t getSeed() const { return rng.getSeed(); }
+    int getFeatureSize() const { return feature_size; }
+
+    // Fuel type, density and moisture of the w x h block at (x0, y0), encoded
+    // like the Grid fields. Row y of the block starts at y * stride in each
+    // array. Lattice values are computed once per tile, not per cell.
+    void generate(int x0, int y0, int w, int h, uint8_t* fuel_types, uint8_t* densities, uint8_t* moistures,
+                  ptrdiff_t stride) const;
+    // One cell, the same as generate() gives it
+    Cell cellAt(int x, int y) const;
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+
+// Stateless counter-based random numbers (Philox4x32-10, Salmon et al. 2011).
+// Every draw is a pure function of the seed and a counter made of
+// (step, cell, stream, block), so results do not depend on how many threads
+// run the update or in which order cells are visited. Cells are 64-bit
+// landscape indices: the low word is the first counter word and the high
+// word shares the last one with the block, so landscapes past 2^32 cells do
+// not repeat draws.
+class CounterRng {
+private:
+    uint32_t key[2];
+
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
+
+public:
+    // Streams keep the different uses of one seed independent
+    enum Stream : uint32_t {
+        SPREAD = 0,         // Neighbour ignition, one lane per direction
+        EXTINGUISH = 1,     // Suppression putting out a burning cell
+        TERRAIN = 2,        // Random terrain generation
+        BITPLANE = 3,       // Bitplane engine spread, one 64-cell word per counter
+        PROCEDURAL = 4      // Procedural terrain lattice values
+    };
+
+    explicit CounterRng(uint64_t seed = 0) { setSeed(seed); }
+
+    void setSeed(uint64_t seed) {
+        key[0] = static_cast<uint32_t>(seed);
+        key[1] = static_cast<uint32_t>(seed >> 32);
+    }
+    uint64_t getSeed() const { return (static_cast<uint64_t>(key[1]) << 32) | key[0]; }
+
+    // Four independent 32-bit words for one counter value. Callers use far
+    // fewer than 256 blocks per counter, which leaves the upper 24 bits of the
+    // last word for the cell's high word.
+    void block(uint32_t step, uint64_t cell, uint32_t stream, uint32_t block_index, uint32_t out[4]) const {
+        uint32_t c0 = static_cast<uint32_t>(cell), c1 = step, c2 = stream;
+        uint32_t c3 = block_index | static_cast<uint32_t>(cell >> 32) << 8;
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(kMultiplier0, c0, hi0, lo0);
+            mulhilo(kMultiplier1, c2, hi1, lo1);
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+            k0 += kWeyl0;
+            k1 += kWeyl1;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    // Uniform doubles in [0, 1) for lanes [0, count) of one counter, four lanes per Philox call
+    void uniforms(uint32_t step, uint64_t cell, uint32_t stream, int count, double* out) const {
+        uint32_t words[4];
+        for (int lane = 0; lane < count; ++lane) {
+            if (lane % 4 == 0) {
+                block(step, cell, stream, lane / 4, words);
+            }
+            out[lane] = toUniform(words[lane % 4]);
+        }
+    }
+
+    double uniform(uint32_t step, uint64_t cell, uint32_t stream, uint32_t lane = 0) const {
+        uint32_t words[4];
+        block(step, cell, stream, lane / 4, words);
+        return toUniform(words[lane % 4]);
+    }
+
+    // One lane for many cells at once. Each iteration is independent, so the
+    // compiler can run the rounds for several cells per vector instruction.
+    void batch(uint32_t step, const uint64_t* cells, int count, uint32_t stream, uint32_t lane,
+               uint32_t* out) const {
+        for (int i = 0; i < count; ++i) {
+            uint32_t words[4];
+            block(step, cells[i], stream, lane / 4, words);
+            out[i] = words[lane % 4];
+        }
+    }
+
+    // 64 bits for one counter from two SplitMix64 finalizer rounds instead of
+    // Philox: a fraction of the cost, for callers that consume whole words of
+    // random bits (bit-sliced draws) and need many of them per cell
+    uint64_t bits64(uint32_t step, uint64_t cell, uint32_t stream, uint32_t lane) const {
+        return bits64(cellKey(step, cell), stream, lane);
+    }
+
+    // The first round only depends on (step, cell); callers drawing many
+    // lanes for one cell can compute it once. The cell's high word is mixed
+    // in separately and adds nothing below 2^32 cells.
+    uint64_t cellKey(uint32_t step, uint64_t cell) const {
+        return mix64(getSeed() + ((static_cast<uint64_t>(step) << 32) | static_cast<uint32_t>(cell)) *
+                                 0x9E3779B97F4A7C15ULL + mix64(cell >> 32));
+    }
+
+    static uint64_t bits64(uint64_t cell_key, uint32_t stream, uint32_t lane) {
+        return mix64(cell_key + ((static_cast<uint64_t>(stream) << 32) | lane) * 0xD1B54A32D192ED03ULL);
+    }
+
+    static uint64_t mix64(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static double toUniform(uint32_t bits) {
+        return bits * (1.0 / 4294967296.0);
+    }
+};
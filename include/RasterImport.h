@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class FuelLayer;
+class ThreadPool;
+
+// Fuel type, density and moisture rasters read from disk into a RASTER
+// FuelLayer. Rows run north to south, so the first row is y 0, the same as
+// the ESRI ASCII grids written by Ensemble and ArrivalTimeSolver.
+//
+// A path ending in .asc is an ESRI ASCII grid. Any other path is a raw binary
+// raster described by an ESRI .hdr file with the same base name. The .hdr
+// keys are ncols, nrows, nbits (8, 16, 32 or 64), pixeltype (unsignedint,
+// signedint or float), byteorder (lsbfirst/I or msbfirst/M), skipbytes and
+// nodata; a .flt file is always 32-bit float. Other .hdr keys are ignored.
+//
+// Both formats are mapped into memory and converted by the thread pool in
+// row-independent chunks. An ASCII grid is parsed in two passes: the first
+// counts the values in each chunk so the second knows where each chunk's
+// values go. No value allocates.
+//
+// Fuel types are the FuelType codes 0-4. Densities and moistures are
+// fractions, clamped to 0-1. NODATA never burns: it gives ROCK, density 0
+// and moisture 1. NaN also counts as NODATA.
+class RasterImport {
+public:
+    enum class Field {
+        FUEL_TYPE,
+        DENSITY,
+        MOISTURE
+    };
+
+    struct Header {
+        int width, height;
+        bool has_nodata;
+        double nodata;
+        // Binary rasters only
+        int element_bytes;
+        bool is_float, is_signed, swap_bytes;
+        uint64_t skip_bytes;
+    };
+
+private:
+    // Converts one raster into out (width * height bytes, encoded like the
+    // FuelLayer fields); width and height must match the header
+    static bool readAscii(const std::string& path, Field field, int width, int height, ThreadPool* pool,
+                          uint8_t* out, std::string& error);
+    static bool readBinary(const std::string& path, const Header& header, Field field, ThreadPool* pool,
+                           uint8_t* out, std::string& error);
+
+public:
+    static bool isAsciiPath(const std::string& path);
+    // The .hdr next to a binary raster: path with its extension replaced
+    static std::string headerPath(const std::string& path);
+    // Reads just the size and encoding of a raster, without its values
+    static bool readHeader(const std::string& path, Header& header, std::string& error);
+
+    // Loads all three rasters, which must have the same size. An empty
+    // density or moisture path fills that field with the Cell default.
+    // Returns false and sets error on failure; layer is then unchanged.
+    // pool may be null to convert on the calling thread.
+    static bool load(const std::string& fuel_path, const std::string& density_path,
+                     const std::string& moisture_path, ThreadPool* pool, FuelLayer& layer, std::string& error);
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+class FireSimulation;
+class Grid;
+
+// Binary snapshot of a whole simulation: every grid field, weather, the random
+// stream position, the clock, crews and evacuation zones. Restoring one and
+// stepping on gives the same result as never having stopped.
+//
+// File layout (native byte order, recorded in the header):
+//   0                 SnapshotHeader, then header.field_count SnapshotField entries
+//   header_bytes      Field arrays, each starting on a kSnapshotAlignment boundary and
+//                     stored exactly as Grid holds it in memory, ghost border included
+//                     (header.stride * (header.height + 2 * header.halo) elements),
+//                     so a reader can mmap the file and use the arrays in place
+//   metadata_offset   Scalars, suppression end times by cell index, crews, zones
+//                     and pending suppression actions, written field by field
+// The header checksum covers the header and field table (with the checksum
+// itself zeroed); each array and the metadata have their own checksum.
+
+constexpr uint32_t kSnapshotVersion = 4;    // 2: pending suppression actions, 3: suppression end times,
+                                            // 4: end times in the metadata, for suppressed cells only
+constexpr uint32_t kSnapshotAlignment = 4096;
+constexpr uint32_t kSnapshotByteOrder = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];              // "WFSNAP\r\n"
+    uint32_t version;
+    uint32_t byte_order;        // kSnapshotByteOrder as the writer saw it
+    uint32_t header_bytes;      // Header and field table, padded to kSnapshotAlignment
+    uint32_t field_count;
+    int32_t width, height;
+    int32_t halo, stride;
+    uint64_t file_bytes;
+    uint64_t metadata_offset;
+    uint64_t metadata_bytes;
+    uint64_t metadata_checksum;
+    uint64_t checksum;
+};
+
+struct SnapshotField {
+    char name[24];              // Grid member name, zero padded
+    uint32_t element_bytes;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t checksum;
+};
+
+class SnapshotIO {
+private:
+    // Calls fn(name, array) for every per-cell array of the grid, in file order
+    template <typename GridType, typename Fn>
+    static void forEachField(GridType& grid, Fn&& fn);
+
+public:
+    // Both return false and set error on failure; a failed load leaves the
+    // simulation unchanged
+    static bool save(const FireSimulation& sim, const std::string& path, std::string& error);
+    static bool load(FireSimulation& sim, const std::string& path, std::string& error);
+
+    // 64-bit checksum used for the header, arrays and metadata
+    static uint64_t checksum(const void* data, uint64_t bytes);
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform-grid spatial hash over integer cell coordinates. The plane is cut
+// into square buckets of kBucketSize cells and only occupied buckets are
+// stored. An item is an int handle; point items live in one bucket, box
+// items in every bucket their box overlaps. Any coordinates are accepted,
+// including ones outside the simulation grid.
+class SpatialHash {
+private:
+    static constexpr int kBucketShift = 4;
+    std::unordered_map<uint64_t, std::vector<int>> buckets;
+
+    static uint64_t key(int bucket_x, int bucket_y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(bucket_x)) << 32) | static_cast<uint32_t>(bucket_y);
+    }
+
+public:
+    static constexpr int kBucketSize = 1 << kBucketShift;
+    // Floor division, so negative coordinates get their own buckets
+    static int bucketOf(int coordinate) { return coordinate >> kBucketShift; }
+
+    void clear() { buckets.clear(); }
+
+    // Boxes are inclusive: [x0, x1] x [y0, y1]
+    void insert(int item, int x0, int y0, int x1, int y1);
+    void remove(int item, int x0, int y0, int x1, int y1);
+    void insert(int item, int x, int y) { insert(item, x, y, x, y); }
+    void remove(int item, int x, int y) { remove(item, x, y, x, y); }
+    void move(int item, int old_x, int old_y, int new_x, int new_y);
+
+    // Number of buckets a query over the box would visit
+    static int64_t bucketSpan(int x0, int y0, int x1, int y1) {
+        return static_cast<int64_t>(bucketOf(x1) - bucketOf(x0) + 1) * (bucketOf(y1) - bucketOf(y0) + 1);
+    }
+
+    // Calls fn(item) for every item in a bucket that overlaps the box. Point
+    // items are reported once; the caller still filters by exact position.
+    template <typename Fn>
+    void forEachInBox(int x0, int y0, int x1, int y1, Fn&& fn) const {
+        for (int by = bucketOf(y0); by <= bucketOf(y1); ++by) {
+            for (int bx = bucketOf(x0); bx <= bucketOf(x1); ++bx) {
+                auto bucket = buckets.find(key(bx, by));
+                if (bucket == buckets.end()) continue;
+                for (int item : bucket->second) fn(item);
+            }
+        }
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+// Neighbourhoods for fire spread, fixed at compile time so loops over them
+// unroll and need no storage. Offsets are listed in row-major order without
+// the centre; the position in the list is the random-number lane.
+struct StencilOffset {
+    int dx, dy;
+};
+
+enum class SpreadStencil {
+    MOORE_8,        // 3x3 block (default)
+    VON_NEUMANN_4,  // Edge neighbours only
+    EXTENDED_16,    // Ring at distance 2, for long-range spread
+    EXTENDED_24     // 5x5 block
+};
+
+struct Moore8 {
+    static constexpr int kSize = 8;
+    static constexpr int kRadius = 1;
+    static constexpr StencilOffset kOffsets[kSize] = {
+        {-1, -1}, {0, -1}, {1, -1},
+        {-1,  0},          {1,  0},
+        {-1,  1}, {0,  1}, {1,  1}
+    };
+};
+
+struct VonNeumann4 {
+    static constexpr int kSize = 4;
+    static constexpr int kRadius = 1;
+    static constexpr StencilOffset kOffsets[kSize] = {
+                  {0, -1},
+        {-1,  0},          {1,  0},
+                  {0,  1}
+    };
+};
+
+struct Extended16 {
+    static constexpr int kSize = 16;
+    static constexpr int kRadius = 2;
+    static constexpr StencilOffset kOffsets[kSize] = {
+        {-2, -2}, {-1, -2}, {0, -2}, {1, -2}, {2, -2},
+        {-2, -1},                             {2, -1},
+        {-2,  0},                             {2,  0},
+        {-2,  1},                             {2,  1},
+        {-2,  2}, {-1,  2}, {0,  2}, {1,  2}, {2,  2}
+    };
+};
+
+struct Extended24 {
+    static constexpr int kSize = 24;
+    static constexpr int kRadius = 2;
+    static constexpr StencilOffset kOffsets[kSize] = {
+        {-2, -2}, {-1, -2}, {0, -2}, {1, -2}, {2, -2},
+        {-2, -1}, {-1, -1}, {0, -1}, {1, -1}, {2, -1},
+        {-2,  0}, {-1,  0},          {1,  0}, {2,  0},
+        {-2,  1}, {-1,  1}, {0,  1}, {1,  1}, {2,  1},
+        {-2,  2}, {-1,  2}, {0,  2}, {1,  2}, {2,  2}
+    };
+};
+
+// Largest radius of the stencils above
+constexpr int kMaxStencilRadius = 2;
+
+// Offsets of a stencil picked at run time; returns the count
+inline int getStencilOffsets(SpreadStencil stencil, const StencilOffset** offsets) {
+    switch (stencil) {
+        case SpreadStencil::VON_NEUMANN_4: *offsets = VonNeumann4::kOffsets; return VonNeumann4::kSize;
+        case SpreadStencil::EXTENDED_16: *offsets = Extended16::kOffsets; return Extended16::kSize;
+        case SpreadStencil::EXTENDED_24: *offsets = Extended24::kOffsets; return Extended24::kSize;
+        default: *offsets = Moore8::kOffsets; return Moore8::kSize;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "FirefightingCrew.h"
+#include "Grid.h"
+#include <vector>
+
+// Suppression actions ordered between steps, applied to the grid together
+// at the start of the next step. All water and retardant drops go to
+// Grid::applyDrops in one call, which folds overlapping drops into one
+// stamp over their union before writing the grid. Firebreaks go through
+// Grid::createFirebreak after the drops (a firebreak does not touch
+// suppression levels, so the order does not change the result). Evacuation
+// actions have no effect on the grid and are dropped.
+class SuppressionQueue {
+private:
+    std::vector<SuppressionAction> pending;
+    std::vector<SuppressionDrop> drops;     // Scratch for apply
+
+public:
+    void push(const SuppressionAction& action) { pending.push_back(action); }
+    // Applies and removes every pending action
+    void apply(Grid& grid);
+    void clear() { pending.clear(); }
+
+    bool empty() const { return pending.empty(); }
+    size_t size() const { return pending.size(); }
+    const std::vector<SuppressionAction>& getPending() const { return pending; }
+};
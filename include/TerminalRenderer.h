@@ -0,0 +1,54 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Grid;
+class HumanFactorManager;
+
+// Live view of a simulation on an ANSI terminal. Each frame is composed into
+// a reusable screen buffer (status text, then the bordered grid) and only the
+// runs of characters that differ from the previous frame are sent, each
+// after a cursor move, in a single write. Crews are drawn over the composed
+// grid in one pass over the crew list. Grids larger than the terminal are
+// scaled down by whole blocks of cells; a block shows its most significant
+// cell (crew, fire, suppression, burned, fuel, empty in that order).
+class TerminalRenderer {
+private:
+    int terminal_fd;            // Queried for the window size when none is set
+    int fixed_columns, fixed_rows;
+
+    // Layout of the frame last drawn; a change forces a full redraw
+    int scale;                  // Cells per character along each axis
+    int view_width, view_height;    // Grid area in characters, without the border
+    bool drawn;
+
+    std::vector<std::string> status_lines;
+    std::vector<std::string> shown_status;
+    std::vector<char> frame;            // Bordered grid area, (view_width + 2) * (view_height + 2)
+    std::vector<char> shown;            // frame as last drawn
+    std::string output;
+    size_t last_output_bytes;
+
+    void terminalSize(int& columns, int& rows) const;
+    void splitStatus(const std::string& status, int columns);
+    void composeGrid(const Grid& grid, const HumanFactorManager& human);
+    void moveCursor(int row, int column);
+
+public:
+    explicit TerminalRenderer(int fd = 1);
+
+    // Overrides the detected window size; 0, 0 goes back to detecting it
+    void setTerminalSize(int columns, int rows);
+
+    // Draws status (any number of lines) above the grid
+    void render(const Grid& grid, const HumanFactorManager& human, const std::string& status,
+                std::ostream& out);
+    // Leaves the cursor below the last frame and makes it visible again
+    void finish(std::ostream& out);
+    // Forgets the screen contents, so the next frame is drawn in full
+    void invalidate() { drawn = false; }
+
+    int getScale() const { return scale; }
+    size_t getLastOutputBytes() const { return last_output_bytes; }
+};
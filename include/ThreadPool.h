@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that stay alive between parallel sections, so
+// per-step work can be split without paying for thread creation every step.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    
+    // The task is type-erased to a function pointer plus the caller's callable,
+    // so a parallel section never copies the task or allocates
+    void (*current_invoke)(const void*, int);
+    const void* current_task;
+    int task_count;
+    std::atomic<int> next_task;
+    int busy_workers;
+    unsigned generation;    // Bumped for every parallelFor call
+    bool stopping;
+    
+    void workerLoop();
+    void runTasks();
+    void run(int count, void (*invoke)(const void*, int), const void* task);
+    
+public:
+    explicit ThreadPool(int thread_count = 1);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    // Total threads taking part in parallelFor, including the caller
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+    
+    // Runs task(i) for every i in [0, count) and returns once all have finished.
+    // The calling thread works on tasks too.
+    template <typename Task>
+    void parallelFor(int count, const Task& task) {
+        run(count, [](const void* fn, int i) { (*static_cast<const Task*>(fn))(i); }, &task);
+    }
+};
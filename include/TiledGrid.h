@@ -0,0 +1,96 @@
+#pragma once
+#include "Grid.h"
+#include "FuelLayer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+// A landscape far larger than the part that burns, cut into square tiles.
+// A tile stays pristine (a null slot read from the fuel layer) until fire
+// comes within stencil reach of it or a caller changes one of its cells. It
+// then becomes a full Grid of tile_size x tile_size cells, so memory follows
+// the area the incident touches, not the extent of the map.
+//
+// Fire crosses tile edges the way it crosses subdomains in
+// DomainDecomposition. Before each step, the burning cells within reach of a
+// neighbouring tile become that tile's halo sources. Tiles draw with their
+// landscape cell keys, so the result matches one Grid filled from the same
+// layer. Tiles with no fire, no suppression timer and no halo sources are
+// not stepped. BITPLANE is stepped as ACTIVE_FRONT.
+class TiledGrid {
+private:
+    FuelLayer fuel;
+    int width, height;
+    int tile_size;
+    int tile_columns, tile_rows;
+    std::vector<std::unique_ptr<Grid>> tiles;   // Null while pristine
+    std::vector<int> materialized;              // Tiles with a Grid, in creation order
+    std::vector<int> stepping;                  // Scratch: tiles updated this step
+
+    // Applied to every tile, including ones created later
+    uint64_t seed;
+    double wind_speed, wind_direction;
+    double ambient_temp, humidity;
+    SpreadStencil spread_stencil;
+    UpdateMode update_mode;
+    uint32_t step_count;
+    double clock;
+    ThreadPool* thread_pool;    // Not owned; null steps tiles on the caller
+
+    int tileOf(int x, int y) const { return (y / tile_size) * tile_columns + x / tile_size; }
+    int tileX0(int tile) const { return (tile % tile_columns) * tile_size; }
+    int tileY0(int tile) const { return (tile / tile_columns) * tile_size; }
+    Grid& materialize(int tile);
+    // The tile holding (x, y), created if needed and brought up to the clock
+    Grid& tileAt(int x, int y);
+    void collectHaloSources();
+    template <typename Fn>
+    void forEachTileInBox(int x0, int y0, int x1, int y1, Fn&& fn);
+
+public:
+    static constexpr int kDefaultTileSize = 256;
+
+    explicit TiledGrid(FuelLayer fuel, int tile_size = kDefaultTileSize);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getTileSize() const { return tile_size; }
+    bool isValidPosition(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    const FuelLayer& getFuelLayer() const { return fuel; }
+
+    Cell getCell(int x, int y) const;
+    CellState getCellState(int x, int y) const;
+    SuppressionEffect getSuppressionEffect(int x, int y) const;
+
+    // Same meaning as on Grid; each creates the tiles it touches
+    void setCell(int x, int y, const Cell& cell);
+    void igniteCell(int x, int y);
+    void applyWaterDrop(int x, int y, int radius, double effectiveness, double duration);
+    void applyRetardant(int x, int y, int radius, double effectiveness, double duration);
+    void createFirebreak(int x1, int y1, int x2, int y2);
+
+    void setSeed(uint64_t new_seed);
+    uint64_t getSeed() const { return seed; }
+    void setWindSpeed(double speed);
+    void setWindDirection(double direction);
+    void setAmbientTemp(double temp);
+    void setHumidity(double humid);
+    void setSpreadStencil(SpreadStencil stencil);
+    void setUpdateMode(UpdateMode mode);
+    void setThreadPool(ThreadPool* pool) { thread_pool = pool; }
+    uint32_t getStepCount() const { return step_count; }
+    double getClock() const { return clock; }
+
+    void update(double dt);
+
+    // Summed over the tiles that exist; pristine tiles neither burn nor have burned
+    int getBurningCount() const;
+    int getBurnedCount() const;
+    int getTileCount() const { return tile_columns * tile_rows; }
+    int getMaterializedTileCount() const { return static_cast<int>(materialized.size()); }
+    // Tile grids, the tile table and the fuel layer
+    size_t getAllocatedBytes() const;
+};
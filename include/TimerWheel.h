@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel of deadlines in simulated seconds, each carrying
+// an int item (Grid uses cell indices). Time is cut into ticks; level 0 has
+// one slot per tick for the next kSlots ticks and every further level spans
+// kSlots times the level below, so scheduling is O(1) and advancing costs
+// the ticks passed plus the entries that are due or move down a level, not
+// the number of pending timers. Deadlines beyond the top level wait in an
+// overflow list that is looked at once per turn of the top level.
+//
+// advance(time, fn) calls fn(item, deadline) exactly for the entries whose
+// deadline is <= time; ticks only decide where entries wait. Entries are not
+// cancelled: an owner that moves a deadline schedules it again and ignores
+// the stale entry when it comes due.
+class TimerWheel {
+private:
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr int kLevels = 4;
+
+    struct Entry {
+        double deadline;
+        int item;
+    };
+
+    double tick_seconds;
+    int64_t current_tick;       // Earlier ticks are done; this one may still hold entries
+    std::vector<Entry> slots[kLevels][kSlots];
+    std::vector<Entry> overflow;
+    std::vector<Entry> moving;  // Scratch for the slot being emptied
+    size_t count;
+
+    int64_t tickOf(double time) const;
+    void place(const Entry& entry);
+    void cascade(std::vector<Entry>& slot);
+
+public:
+    explicit TimerWheel(double tick = 0.1);
+
+    // Drops every entry and makes time the wheel's present
+    void reset(double time);
+    void schedule(double deadline, int item);
+
+    template <typename Fn>
+    void advance(double time, Fn&& fn) {
+        int64_t target = tickOf(time);
+        for (int64_t tick = current_tick; tick <= target; ++tick) {
+            current_tick = tick;
+            // Moving into a new span of a level brings its entries one level down
+            for (int level = 1; level < kLevels; ++level) {
+                int64_t low_bits = tick & ((int64_t(1) << (level * kSlotBits)) - 1);
+                if (low_bits != 0) break;
+                cascade(slots[level][(tick >> (level * kSlotBits)) & (kSlots - 1)]);
+                if (level == kLevels - 1) cascade(overflow);
+            }
+            
+            moving.swap(slots[0][tick & (kSlots - 1)]);
+            for (const Entry& entry : moving) {
+                if (entry.deadline <= time) {
+                    count--;
+                    fn(entry.item, entry.deadline);
+                } else {
+                    place(entry);   // Later in the last tick; stays for the next call
+                }
+            }
+            moving.clear();
+        }
+    }
+
+    bool empty() const { return count == 0; }
+    // Pending entries, stale ones included
+    size_t size() const { return count; }
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Grid;
+struct EvacuationZone;
+
+// Keeps EvacuationZone::danger_level current from the fire around each zone.
+// Every zone covers the grid cells within its radius ("inside") and a ring
+// around it ("near", kNearMargin or the radius again, whichever is larger).
+// The covered cells are laid out once, and only they are stored, so memory
+// follows the zone disks rather than the map. After that each update only
+// visits the grid's change log and adjusts per-zone burning/burned counters
+// for the covered cells in it, so the per-step cost follows the fire
+// activity and not the number or size of zones.
+//
+// Danger weighs burning cells inside fully, burning cells near at one half
+// and burned cells inside at one quarter, and reaches 1.0 when that weighted
+// count equals a tenth of the cells inside.
+class ZoneDangerTracker {
+private:
+    static constexpr int kNearMargin = 5;
+
+    struct ZoneCounts {
+        int inside_cells;
+        int burning_inside, burned_inside;
+        int burning_near, burned_near;
+    };
+
+    bool synced;                    // Layout and counters match the zones and the grid
+    int width, height;
+    int x_min, y_min, x_max, y_max; // Box around every covered cell, to skip the lookup
+    std::unordered_map<uint64_t, int> cell_slots;   // y * width + x -> slot, covered cells only
+    std::vector<uint64_t> slot_cells;   // y * width + x per slot
+    std::vector<uint8_t> slot_states;   // CellState last seen per covered cell
+    std::vector<int> slot_links;    // Slot s owns links [slot_links[s], slot_links[s + 1])
+    std::vector<int> link_zones;    // Zone index and whether the cell is inside it
+    std::vector<uint8_t> link_inside;
+    std::vector<ZoneCounts> counts;
+
+    void build(const Grid& grid, const std::vector<EvacuationZone>& zones);
+    void count(int slot, uint8_t state, int delta);
+
+public:
+    ZoneDangerTracker();
+
+    // Forces a rebuild on the next update, after zones were added or the
+    // grid was replaced
+    void invalidate() { synced = false; }
+
+    // Applies the grid's change log (see Grid::setChangeLogEnabled) and sets
+    // every zone's danger_level. The caller clears the log afterwards.
+    void update(const Grid& grid, std::vector<EvacuationZone>& zones);
+};
@@ -0,0 +1,159 @@
+#include "ArrivalTime.h"
+#include "Grid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+void ArrivalTimeSolver::RadixHeap::clear() {
+    for (auto& bucket : buckets) bucket.clear();
+    last = 0;
+    count = 0;
+}
+
+void ArrivalTimeSolver::RadixHeap::push(double key, int value) {
+    uint64_t bits = keyBits(key);
+    buckets[bucketOf(bits)].emplace_back(bits, value);
+    count++;
+}
+
+void ArrivalTimeSolver::RadixHeap::pop(double& key, int& value) {
+    if (buckets[0].empty()) {
+        // Everything in the first non-empty bucket shares the bits above its
+        // index with last; moving last to its minimum spreads it over lower
+        // buckets, and keys only ever grow, so no other bucket is touched
+        int b = 1;
+        while (buckets[b].empty()) ++b;
+        uint64_t lowest = buckets[b][0].first;
+        for (const auto& entry : buckets[b]) lowest = std::min(lowest, entry.first);
+        last = lowest;
+        for (const auto& entry : buckets[b]) buckets[bucketOf(entry.first)].push_back(entry);
+        buckets[b].clear();
+    }
+    uint64_t bits = buckets[0].back().first;
+    value = buckets[0].back().second;
+    buckets[0].pop_back();
+    count--;
+    std::memcpy(&key, &bits, sizeof(key));
+}
+
+ArrivalTimeSolver::ArrivalTimeSolver() : width(0), height(0), reached_count(0), max_arrival_time(0.0) {
+}
+
+void ArrivalTimeSolver::solve(const Grid& grid) {
+    width = grid.getWidth();
+    height = grid.getHeight();
+    const double unreached = std::numeric_limits<double>::infinity();
+    times.assign(grid.states.size(), unreached);
+    
+    // What a cell contributes to the probability of catching fire from any
+    // neighbour: 0 where fire cannot enter, as in Grid::spreadProbabilityAt
+    receptivity.assign(grid.states.size(), 0.0);
+    hazards.assign(grid.states.size(), Hazard{0.0, 0.0, 0.0, 0.0});
+    settled.assign(grid.states.size(), 0);
+    heap.clear();
+    for (int y = 0; y < height; ++y) {
+        for (int idx = grid.index(0, y); idx < grid.index(width, y); ++idx) {
+            if (static_cast<CellState>(grid.states[idx]) == CellState::BURNING) {
+                times[idx] = 0.0;
+                heap.push(0.0, idx);
+            } else if (grid.canBurnAt(idx) && !grid.firebreaks[idx]) {
+                receptivity[idx] = grid.ignitionProbabilityAt(idx) * 0.1 * (1.0 - grid.suppressionModifierAt(idx));
+            }
+        }
+    }
+    
+    // Edges as index offsets with their wind and distance kernel
+    const StencilOffset* offsets;
+    int offset_count = getStencilOffsets(grid.spread_stencil, &offsets);
+    int edge_offsets[kMaxEdges];
+    double edge_kernels[kMaxEdges];
+    for (int direction = 0; direction < offset_count; ++direction) {
+        const StencilOffset& offset = offsets[direction];
+        edge_offsets[direction] = offset.dy * grid.stride + offset.dx;
+        edge_kernels[direction] = grid.spread_kernel[(offset.dy + 2) * 5 + (offset.dx + 2)];
+    }
+    double fresh_heat = grid.sourceHeatFactor(Grid::kIgnitionTemperature);
+    
+    // Ghost cells have no receptivity, so neighbours need no bounds checks
+    while (!heap.empty()) {
+        double time;
+        int from;
+        heap.pop(time, from);
+        if (time > times[from] || settled[from]) continue;  // Stale entry
+        settled[from] = 1;
+        
+        double heat = time == 0.0 ? grid.sourceHeatFactor(grid.temperatures[from]) : fresh_heat;
+        for (int direction = 0; direction < offset_count; ++direction) {
+            int to = from + edge_offsets[direction];
+            double rate = std::min(1.0, receptivity[to] * edge_kernels[direction] * heat);
+            if (rate <= 0.0 || settled[to]) continue;
+            
+            Hazard& hazard = hazards[to];
+            if (hazard.rate == 0.0) {
+                hazard.expected = time;
+                hazard.survival = 1.0;
+            } else {
+                // Close the interval since the previous neighbour caught fire
+                double decay = std::exp(-hazard.rate * (time - hazard.since));
+                hazard.expected += hazard.survival * (1.0 - decay) / hazard.rate;
+                hazard.survival *= decay;
+            }
+            hazard.since = time;
+            hazard.rate += rate;
+            
+            // Not earlier than now, which keeps the queue monotone
+            double arrival = std::max(time, hazard.expected + hazard.survival / hazard.rate);
+            if (arrival < times[to]) {
+                times[to] = arrival;
+                heap.push(arrival, to);
+            }
+        }
+    }
+    
+    arrival_times.assign(static_cast<size_t>(width) * height, kUnreached);
+    reached_count = 0;
+    max_arrival_time = 0.0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double time = times[grid.index(x, y)];
+            if (time == unreached) continue;
+            arrival_times[y * width + x] = static_cast<float>(time);
+            reached_count++;
+            max_arrival_time = std::max(max_arrival_time, time);
+        }
+    }
+}
+
+int ArrivalTimeSolver::countReachedBy(double time) const {
+    int count = 0;
+    for (float arrival : arrival_times) {
+        if (arrival <= time) count++;
+    }
+    return count;
+}
+
+bool ArrivalTimeSolver::saveRaster(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+    
+    file << "ncols " << width << "\n";
+    file << "nrows " << height << "\n";
+    file << "xllcorner 0\n";
+    file << "yllcorner 0\n";
+    file << "cellsize 1\n";
+    file << "NODATA_value -9999\n";
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (x > 0) file << ' ';
+            if (isReached(x, y)) {
+                file << getArrivalTime(x, y);
+            } else {
+                file << -9999;
+            }
+        }
+        file << "\n";
+    }
+    file.close();
+    return !file.fail();
+}
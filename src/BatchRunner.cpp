@@ -0,0 +1,748 @@
+#include "BatchRunner.h"
+#include "FireSimulation.h"
+#include "Ensemble.h"
+#include "ArrivalTime.h"
+#include "DomainDecomposition.h"
+#include "TiledGrid.h"
+#include "RasterImport.h"
+#include "ThreadPool.h"
+#include "TerminalRenderer.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+bool parseLong(const char* text, long& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0) return false;
+    value = parsed;
+    return true;
+}
+
+bool parseInt(const char* text, int& value) {
+    long parsed;
+    if (!parseLong(text, parsed) || parsed < -2147483647L || parsed > 2147483647L) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool parseDouble(const char* text, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno != 0) return false;
+    value = parsed;
+    return true;
+}
+
+// Decimal digits only: strtoull would wrap "-1" around and skip leading
+// blanks, and another base would quietly run a different seed
+bool parseSeed(const char* text, uint64_t& value) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (*end != '\0' || errno != 0) return false;
+    value = parsed;
+    return true;
+}
+
+// "X,Y"
+bool parsePoint(const char* text, std::pair<int, int>& point) {
+    std::string value = text;
+    size_t comma = value.find(',');
+    if (comma == std::string::npos) return false;
+    return parseInt(value.substr(0, comma).c_str(), point.first) &&
+           parseInt(value.substr(comma + 1).c_str(), point.second);
+}
+
+SpreadStencil parseStencilName(const std::string& name) {
+    if (name == "vonneumann4") return SpreadStencil::VON_NEUMANN_4;
+    if (name == "extended16") return SpreadStencil::EXTENDED_16;
+    if (name == "extended24") return SpreadStencil::EXTENDED_24;
+    return SpreadStencil::MOORE_8;
+}
+
+UpdateMode parseEngineName(const std::string& name) {
+    if (name == "full") return UpdateMode::FULL_SCAN;
+    if (name == "bitplane") return UpdateMode::BITPLANE;
+    return UpdateMode::ACTIVE_FRONT;
+}
+
+void setupScenario(FireSimulation& sim, const std::string& scenario) {
+    if (scenario == "grassland") {
+        sim.setupGrassland();
+    } else if (scenario == "forest") {
+        sim.setupForest();
+    } else if (scenario == "mixed") {
+        sim.setupMixed();
+    } else if (scenario == "procedural") {
+        sim.setupProcedural();
+    } else {
+        sim.getGrid().initializeTerrain();
+    }
+}
+
+// Scenario names and paths come from the command line, so escape them
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+bool checkIgnitionPoints(const BatchOptions& options, std::string& error) {
+    for (const auto& point : options.ignition_points) {
+        if (point.first < 0 || point.first >= options.width ||
+            point.second < 0 || point.second >= options.height) {
+            error = "ignition point " + std::to_string(point.first) + "," +
+                    std::to_string(point.second) + " is outside the grid";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Single runs and ensembles step one dense Grid of the whole landscape, whose
+// cells are addressed by int; larger landscapes need tiles or ranks
+bool checkDenseSize(const BatchOptions& options, std::string& error) {
+    if (options.tile_size > 0 || options.ranks > 1 || !options.restore_path.empty()) return true;
+    if (Grid::fitsIndex(options.width, options.height)) return true;
+    error = "a " + std::to_string(options.width) + "x" + std::to_string(options.height) +
+            " grid is too large for a single dense grid; use --tile-size or --ranks";
+    return false;
+}
+
+} // namespace
+
+void printBatchUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--threads N]\n"
+              << "       " << program << " --batch [options]\n"
+              << "Batch options:\n"
+              << "  --scenario NAME      grassland, forest, mixed, terrain or procedural (default\n"
+              << "                       grassland); procedural is fractal noise terrain from the seed\n"
+              << "  --width N            Grid width (default 100)\n"
+              << "  --height N           Grid height (default 100)\n"
+              << "  --wind-speed V       Wind speed in m/s (default 5)\n"
+              << "  --wind-dir D         Wind direction in degrees (default 90)\n"
+              << "  --temp T             Ambient temperature in Celsius (default 25)\n"
+              << "  --humidity H         Relative humidity 0.0-1.0 (default 0.4)\n"
+              << "  --ignite X,Y         Ignition point, repeatable (default grid centre)\n"
+              << "  --stencil NAME       moore8, vonneumann4, extended16 or extended24 (default moore8)\n"
+              << "  --engine NAME        active, full, bitplane or arrival (default active); bitplane\n"
+              << "                       falls back to active on mixed fuel or suppression;\n"
+              << "                       arrival solves expected fire arrival times instead of\n"
+              << "                       stepping, --end-time then counts cells reached by T\n"
+              << "  --seed S             Random seed (default nondeterministic)\n"
+              << "  --steps N            Stop after N steps\n"
+              << "  --end-time T         Stop after T simulated seconds\n"
+              << "  --dt T               Seconds per step (default 0.1)\n"
+              << "  --threads N          Worker threads for the grid update (default 1)\n"
+              << "  --output PATH        Write the final grid to PATH\n"
+              << "  --ensemble N         Run N realizations and report burn-percentage quantiles\n"
+              << "  --burn-prob-out PATH Write the ensemble burn probability as an ESRI ASCII grid\n"
+              << "  --snapshot-out PATH  Write a snapshot of the final state to PATH\n"
+              << "  --restore PATH       Continue from a snapshot; scenario, size, weather, stencil,\n"
+              << "                       engine (unless arrival), seed, dt and ignition options\n"
+              << "                       are then ignored\n"
+              << "  --record PATH        Record a delta-encoded frame stream to PATH\n"
+              << "  --record-every N     Steps between recorded frames (default 10)\n"
+              << "  --watch N            Draw the grid on stderr every N steps\n"
+              << "  --arrival-out PATH   Write arrival times as an ESRI ASCII grid (arrival engine)\n"
+              << "  --ranks N            Split the grid into N subdomains, each stepped by its own\n"
+              << "                       process with halos exchanged through shared memory\n"
+              << "  --tile-size N        Run on a tiled grid that allocates N x N tiles only where\n"
+              << "                       fire or suppression reaches (for very large maps)\n"
+              << "  --fuel-raster PATH   Fuel type codes 0-4 (grass, shrub, tree, water, rock) from\n"
+              << "                       an ESRI ASCII grid (.asc) or a binary raster with an ESRI\n"
+              << "                       .hdr; replaces --scenario, --width and --height\n"
+              << "  --density-raster PATH\n"
+              << "                       Fuel density 0.0-1.0 raster (default 0.8)\n"
+              << "  --moisture-raster PATH\n"
+              << "                       Fuel moisture 0.0-1.0 raster (default 0.3)\n"
+              << "Without --steps or --end-time the run ends when the fire burns out.\n";
+}
+
+bool parseBatchOptions(int argc, char* argv[], BatchOptions& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch") continue;
+        
+        if (i + 1 >= argc) {
+            error = "missing value for " + arg;
+            return false;
+        }
+        const char* value = argv[++i];
+        bool ok = true;
+        
+        if (arg == "--scenario") {
+            options.scenario = value;
+            ok = options.scenario == "grassland" || options.scenario == "forest" ||
+                 options.scenario == "mixed" || options.scenario == "terrain" ||
+                 options.scenario == "procedural";
+        } else if (arg == "--width") {
+            ok = parseInt(value, options.width) && options.width > 0;
+        } else if (arg == "--height") {
+            ok = parseInt(value, options.height) && options.height > 0;
+        } else if (arg == "--wind-speed") {
+            ok = parseDouble(value, options.wind_speed) && options.wind_speed >= 0.0;
+        } else if (arg == "--wind-dir") {
+            ok = parseDouble(value, options.wind_direction);
+        } else if (arg == "--temp") {
+            ok = parseDouble(value, options.temperature);
+        } else if (arg == "--humidity") {
+            ok = parseDouble(value, options.humidity) &&
+                 options.humidity >= 0.0 && options.humidity <= 1.0;
+        } else if (arg == "--ignite") {
+            std::pair<int, int> point;
+            ok = parsePoint(value, point);
+            if (ok) options.ignition_points.push_back(point);
+        } else if (arg == "--stencil") {
+            options.stencil = value;
+            ok = options.stencil == "moore8" || options.stencil == "vonneumann4" ||
+                 options.stencil == "extended16" || options.stencil == "extended24";
+        } else if (arg == "--engine") {
+            options.engine = value;
+            ok = options.engine == "active" || options.engine == "full" || options.engine == "bitplane" ||
+                 options.engine == "arrival";
+        } else if (arg == "--seed") {
+            ok = parseSeed(value, options.seed);
+            options.has_seed = ok;
+        } else if (arg == "--steps") {
+            ok = parseLong(value, options.max_steps) && options.max_steps >= 0;
+        } else if (arg == "--end-time") {
+            ok = parseDouble(value, options.end_time) && options.end_time >= 0.0;
+        } else if (arg == "--dt") {
+            ok = parseDouble(value, options.time_step) && options.time_step > 0.0;
+        } else if (arg == "--threads") {
+            ok = parseInt(value, options.threads) && options.threads > 0;
+        } else if (arg == "--output") {
+            options.output_path = value;
+        } else if (arg == "--ensemble") {
+            ok = parseInt(value, options.ensemble_members) && options.ensemble_members > 0;
+        } else if (arg == "--burn-prob-out") {
+            options.burn_probability_path = value;
+        } else if (arg == "--snapshot-out") {
+            options.snapshot_out_path = value;
+        } else if (arg == "--restore") {
+            options.restore_path = value;
+        } else if (arg == "--record") {
+            options.record_path = value;
+        } else if (arg == "--record-every") {
+            ok = parseInt(value, options.record_every) && options.record_every > 0;
+        } else if (arg == "--watch") {
+            ok = parseInt(value, options.watch_every) && options.watch_every > 0;
+        } else if (arg == "--arrival-out") {
+            options.arrival_out_path = value;
+        } else if (arg == "--ranks") {
+            ok = parseInt(value, options.ranks) && options.ranks > 0;
+        } else if (arg == "--tile-size") {
+            ok = parseInt(value, options.tile_size) && options.tile_size > 0 &&
+                 Grid::fitsIndex(options.tile_size, options.tile_size);
+        } else if (arg == "--fuel-raster") {
+            options.fuel_raster_path = value;
+        } else if (arg == "--density-raster") {
+            options.density_raster_path = value;
+        } else if (arg == "--moisture-raster") {
+            options.moisture_raster_path = value;
+        } else {
+            error = "unknown option " + arg;
+            return false;
+        }
+        
+        if (!ok) {
+            error = "invalid value '" + std::string(value) + "' for " + arg;
+            return false;
+        }
+    }
+    
+    // A fuel raster's size is only known once it is read, so runBatch checks
+    // its ignition points and size
+    if (options.fuel_raster_path.empty() &&
+        (!checkIgnitionPoints(options, error) || !checkDenseSize(options, error))) {
+        return false;
+    }
+    if (options.fuel_raster_path.empty() &&
+        (!options.density_raster_path.empty() || !options.moisture_raster_path.empty())) {
+        error = "--density-raster and --moisture-raster need --fuel-raster";
+        return false;
+    }
+    if (!options.fuel_raster_path.empty() && !options.restore_path.empty()) {
+        error = "--fuel-raster cannot be used with --restore";
+        return false;
+    }
+    if (!options.burn_probability_path.empty() && options.ensemble_members == 0) {
+        error = "--burn-prob-out needs --ensemble";
+        return false;
+    }
+    if (options.ensemble_members > 0 && (!options.snapshot_out_path.empty() ||
+                                         !options.restore_path.empty() || !options.record_path.empty())) {
+        error = "--snapshot-out, --restore and --record cannot be used with --ensemble";
+        return false;
+    }
+    if (!options.arrival_out_path.empty() && options.engine != "arrival") {
+        error = "--arrival-out needs --engine arrival";
+        return false;
+    }
+    if (options.engine == "arrival" && (options.ensemble_members > 0 || !options.output_path.empty() ||
+                                        !options.snapshot_out_path.empty() || !options.record_path.empty() ||
+                                        options.watch_every > 0 || options.max_steps >= 0)) {
+        error = "--engine arrival cannot be used with --ensemble, --output, --snapshot-out, --record,"
+                " --watch or --steps";
+        return false;
+    }
+    if (options.ranks > 1 && (options.ensemble_members > 0 || options.engine == "arrival" ||
+                              options.threads > 1 || !options.output_path.empty() ||
+                              !options.snapshot_out_path.empty() || !options.restore_path.empty() ||
+                              !options.record_path.empty() || options.watch_every > 0)) {
+        error = "--ranks cannot be used with --ensemble, --engine arrival, --threads, --output,"
+                " --snapshot-out, --restore, --record or --watch";
+        return false;
+    }
+    if (options.tile_size > 0 && (options.ensemble_members > 0 || options.engine == "arrival" ||
+                                  options.ranks > 1 || !options.output_path.empty() ||
+                                  !options.snapshot_out_path.empty() || !options.restore_path.empty() ||
+                                  !options.record_path.empty() || options.watch_every > 0)) {
+        error = "--tile-size cannot be used with --ensemble, --engine arrival, --ranks, --output,"
+                " --snapshot-out, --restore, --record or --watch";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Fuel rasters named on the command line, read once before any run
+struct ImportedRasters {
+    FuelLayer fuel;
+    double seconds = 0.0;
+};
+
+// Import time is reported with every kind of run, since startup is what
+// large rasters cost
+std::string rasterFields(const ImportedRasters* rasters) {
+    if (!rasters) return std::string();
+    std::ostringstream fields;
+    fields << ",\"import_seconds\":" << rasters->seconds;
+    return fields.str();
+}
+
+// Scenario, weather and ignition points, shared by single runs and ensembles
+void setupSimulation(FireSimulation& sim, const BatchOptions& options, const ImportedRasters* rasters) {
+    // The seed must be set before the scenario, which may draw random terrain
+    if (options.has_seed) {
+        sim.setSeed(options.seed);
+    }
+    if (rasters) {
+        rasters->fuel.fill(sim.getGrid(), 0, 0);
+    } else {
+        setupScenario(sim, options.scenario);
+    }
+    
+    Grid& grid = sim.getGrid();
+    grid.setWindSpeed(options.wind_speed);
+    grid.setWindDirection(options.wind_direction);
+    grid.setAmbientTemp(options.temperature);
+    grid.setHumidity(options.humidity);
+    grid.setSpreadStencil(parseStencilName(options.stencil));
+    grid.setUpdateMode(parseEngineName(options.engine));
+    
+    if (options.ignition_points.empty()) {
+        sim.addIgnitionPoint(options.width / 2, options.height / 2);
+    } else {
+        for (const auto& point : options.ignition_points) {
+            sim.addIgnitionPoint(point.first, point.second);
+        }
+    }
+}
+
+// runHeadless in chunks of watch_every steps, drawing the grid after each
+// chunk. The view goes to stderr so stdout still carries only the summary.
+long runWatched(FireSimulation& sim, const BatchOptions& options) {
+    TerminalRenderer renderer(2);
+    std::ostringstream status;
+    long steps = 0;
+    while (true) {
+        long chunk = options.watch_every;
+        if (options.max_steps >= 0) {
+            chunk = std::min(chunk, options.max_steps - steps);
+        }
+        long taken = chunk > 0 ? sim.runHeadless(chunk, options.end_time) : 0;
+        steps += taken;
+        
+        status.str("");
+        sim.printStatus(status);
+        renderer.render(sim.getGrid(), sim.getHumanManager(), status.str(), std::cerr);
+        if (taken < chunk || chunk == 0) break;
+    }
+    renderer.finish(std::cerr);
+    return steps;
+}
+
+int runEnsemble(const BatchOptions& options, const ImportedRasters* rasters) {
+    FireSimulation sim(options.width, options.height, options.time_step);
+    setupSimulation(sim, options, rasters);
+    
+    // Members run in parallel, each on one thread
+    Ensemble ensemble(sim.getGrid(), options.time_step);
+    ensemble.setThreadCount(options.threads);
+    
+    auto start_time = std::chrono::steady_clock::now();
+    ensemble.run(options.ensemble_members, sim.getSeed(), options.max_steps, options.end_time);
+    double wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+    
+    bool saved = options.burn_probability_path.empty() ||
+                 ensemble.saveProbabilityRaster(options.burn_probability_path);
+    
+    std::cout << "{\"scenario\":" << jsonString(options.scenario)
+              << ",\"width\":" << options.width
+              << ",\"height\":" << options.height
+              << rasterFields(rasters)
+              << ",\"seed\":" << sim.getSeed()
+              << ",\"threads\":" << ensemble.getThreadCount()
+              << ",\"members\":" << ensemble.getMemberCount()
+              << ",\"burn_percentage\":{\"mean\":" << ensemble.getMeanBurnPercentage()
+              << ",\"min\":" << ensemble.getBurnPercentageQuantile(0.0)
+              << ",\"p05\":" << ensemble.getBurnPercentageQuantile(0.05)
+              << ",\"p25\":" << ensemble.getBurnPercentageQuantile(0.25)
+              << ",\"p50\":" << ensemble.getBurnPercentageQuantile(0.5)
+              << ",\"p75\":" << ensemble.getBurnPercentageQuantile(0.75)
+              << ",\"p95\":" << ensemble.getBurnPercentageQuantile(0.95)
+              << ",\"max\":" << ensemble.getBurnPercentageQuantile(1.0) << "}"
+              << ",\"wall_seconds\":" << wall_seconds
+              << ",\"members_per_second\":"
+              << (wall_seconds > 0.0 ? ensemble.getMemberCount() / wall_seconds : 0.0);
+    if (!options.burn_probability_path.empty()) {
+        std::cout << ",\"burn_probability\":" << jsonString(options.burn_probability_path);
+    }
+    std::cout << "}\n";
+    
+    if (!saved) {
+        std::cerr << "Could not write " << options.burn_probability_path << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// One arrival-time solve from the current fire instead of a stepped run
+int runArrival(FireSimulation& sim, const BatchOptions& options, const ImportedRasters* rasters) {
+    const Grid& grid = sim.getGrid();
+    ArrivalTimeSolver solver;
+    
+    auto start_time = std::chrono::steady_clock::now();
+    solver.solve(grid);
+    double wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+    
+    bool saved = options.arrival_out_path.empty() || solver.saveRaster(options.arrival_out_path);
+    
+    sim.updateStatistics();
+    double cells = static_cast<double>(grid.getWidth()) * grid.getHeight();
+    std::cout << "{\"scenario\":" << jsonString(options.restore_path.empty() ? options.scenario : "restored")
+              << ",\"engine\":\"arrival\""
+              << ",\"width\":" << grid.getWidth()
+              << ",\"height\":" << grid.getHeight()
+              << rasterFields(rasters)
+              << ",\"cells_burning\":" << sim.getCellsBurning()
+              << ",\"total_fuel_cells\":" << sim.getTotalFuelCells()
+              << ",\"cells_reached\":" << solver.getReachedCount()
+              << ",\"max_arrival_time\":" << solver.getMaxArrivalTime();
+    if (options.end_time >= 0.0) {
+        std::cout << ",\"end_time\":" << options.end_time
+                  << ",\"cells_reached_by_end_time\":" << solver.countReachedBy(options.end_time);
+    }
+    std::cout << ",\"wall_seconds\":" << wall_seconds
+              << ",\"cells_per_second\":" << (wall_seconds > 0.0 ? cells / wall_seconds : 0.0);
+    if (!options.restore_path.empty()) {
+        std::cout << ",\"restored_from\":" << jsonString(options.restore_path);
+    }
+    if (!options.arrival_out_path.empty()) {
+        std::cout << ",\"arrival_times\":" << jsonString(options.arrival_out_path);
+    }
+    std::cout << "}\n";
+    
+    if (!saved) {
+        std::cerr << "Could not write " << options.arrival_out_path << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Runs that never hold the whole grid in one Grid pick the seed themselves,
+// since the scenario's fuel layer needs it before anything is built
+uint64_t runSeed(const BatchOptions& options) {
+    if (options.has_seed) return options.seed;
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+// The scenario, or the imported rasters, as a fuel layer: the same cells
+// setupSimulation puts in a grid
+FuelLayer scenarioFuel(const BatchOptions& options, uint64_t seed, ImportedRasters* rasters) {
+    if (rasters) {
+        return std::move(rasters->fuel);
+    }
+    if (options.scenario == "grassland") {
+        return FuelLayer::uniform(options.width, options.height, Cell(FuelType::GRASS, 0.8, 0.2));
+    } else if (options.scenario == "forest") {
+        return FuelLayer::uniform(options.width, options.height, Cell(FuelType::TREE, 0.9, 0.3));
+    } else if (options.scenario == "mixed") {
+        return FuelLayer::random(options.width, options.height, seed);
+    } else if (options.scenario == "procedural") {
+        return FuelLayer::procedural(options.width, options.height, seed);
+    }
+    return FuelLayer::terrain(options.width, options.height);
+}
+
+std::vector<std::pair<int, int>> ignitionPoints(const BatchOptions& options) {
+    if (options.ignition_points.empty()) {
+        return {{options.width / 2, options.height / 2}};
+    }
+    return options.ignition_points;
+}
+
+// One run split over options.ranks processes. Each rank builds its own
+// subdomain from the landscape, so no process holds the whole grid.
+int runDecomposed(const BatchOptions& options, ImportedRasters* rasters) {
+    Landscape landscape;
+    landscape.seed = runSeed(options);
+    landscape.fuel = scenarioFuel(options, landscape.seed, rasters);
+    landscape.wind_speed = options.wind_speed;
+    landscape.wind_direction = options.wind_direction;
+    landscape.ambient_temp = options.temperature;
+    landscape.humidity = options.humidity;
+    landscape.spread_stencil = parseStencilName(options.stencil);
+    landscape.update_mode = parseEngineName(options.engine);
+    landscape.ignition_points = ignitionPoints(options);
+    
+    DomainDecomposition decomposition(options.time_step);
+    std::string error;
+    if (!decomposition.partition(options.width, options.height, options.ranks, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    bool ok = decomposition.run(landscape, options.max_steps, options.end_time, error);
+    double wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+    if (!ok) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    
+    auto secondsList = [](const std::vector<double>& seconds) {
+        std::ostringstream list;
+        for (size_t i = 0; i < seconds.size(); ++i) {
+            list << (i ? "," : "[") << seconds[i];
+        }
+        return list.str() + "]";
+    };
+    double cell_updates = static_cast<double>(options.width) * options.height * decomposition.getSteps();
+    std::cout << "{\"scenario\":" << jsonString(options.scenario)
+              << ",\"width\":" << options.width
+              << ",\"height\":" << options.height
+              << rasterFields(rasters)
+              << ",\"seed\":" << landscape.seed
+              << ",\"ranks\":" << decomposition.getRankCount()
+              << ",\"layout\":\"" << decomposition.getColumns() << "x" << decomposition.getRows() << "\""
+              << ",\"steps\":" << decomposition.getSteps()
+              << ",\"sim_time\":" << decomposition.getSimTime()
+              << ",\"cells_burning\":" << decomposition.getCellsBurning()
+              << ",\"cells_burned\":" << decomposition.getCellsBurned()
+              << ",\"total_fuel_cells\":" << decomposition.getTotalFuelCells()
+              << ",\"burn_percentage\":" << decomposition.getBurnPercentage()
+              << ",\"wall_seconds\":" << wall_seconds
+              << ",\"cells_per_second\":" << (wall_seconds > 0.0 ? cell_updates / wall_seconds : 0.0)
+              << ",\"rank_step_seconds\":" << secondsList(decomposition.getStepSeconds())
+              << ",\"rank_wait_seconds\":" << secondsList(decomposition.getWaitSeconds())
+              << "}\n";
+    return 0;
+}
+
+// One run on a TiledGrid; the scenario becomes its fuel layer
+int runTiled(const BatchOptions& options, ImportedRasters* rasters) {
+    uint64_t seed = runSeed(options);
+    TiledGrid grid(scenarioFuel(options, seed, rasters), options.tile_size);
+    ThreadPool pool(options.threads);
+    grid.setThreadPool(&pool);
+    grid.setSeed(seed);
+    grid.setWindSpeed(options.wind_speed);
+    grid.setWindDirection(options.wind_direction);
+    grid.setAmbientTemp(options.temperature);
+    grid.setHumidity(options.humidity);
+    grid.setSpreadStencil(parseStencilName(options.stencil));
+    grid.setUpdateMode(parseEngineName(options.engine));
+    for (const auto& point : ignitionPoints(options)) {
+        grid.igniteCell(point.first, point.second);
+    }
+    
+    // Same stopping rules as FireSimulation::runHeadless
+    auto start_time = std::chrono::steady_clock::now();
+    double end_limit = options.end_time - options.time_step * 0.5;
+    double sim_time = 0.0;
+    long steps = 0;
+    while (grid.getBurningCount() > 0 && (options.max_steps < 0 || steps < options.max_steps) &&
+           (options.end_time < 0 || sim_time < end_limit)) {
+        grid.update(options.time_step);
+        sim_time += options.time_step;
+        ++steps;
+    }
+    double wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+    
+    std::cout << "{\"scenario\":" << jsonString(options.scenario)
+              << ",\"width\":" << options.width
+              << ",\"height\":" << options.height
+              << rasterFields(rasters)
+              << ",\"seed\":" << grid.getSeed()
+              << ",\"threads\":" << pool.getThreadCount()
+              << ",\"tile_size\":" << grid.getTileSize()
+              << ",\"steps\":" << steps
+              << ",\"sim_time\":" << sim_time
+              << ",\"cells_burning\":" << grid.getBurningCount()
+              << ",\"cells_burned\":" << grid.getBurnedCount()
+              << ",\"tiles\":" << grid.getTileCount()
+              << ",\"tiles_materialized\":" << grid.getMaterializedTileCount()
+              << ",\"allocated_bytes\":" << grid.getAllocatedBytes()
+              << ",\"wall_seconds\":" << wall_seconds
+              << "}\n";
+    return 0;
+}
+    
+} // namespace
+
+int runBatch(const BatchOptions& batch_options) {
+    // Rasters decide the grid size, so they are read before anything is built
+    BatchOptions options = batch_options;
+    ImportedRasters imported;
+    ImportedRasters* rasters = nullptr;
+    if (!options.fuel_raster_path.empty()) {
+        std::string error;
+        ThreadPool pool(options.threads);
+        auto start_time = std::chrono::steady_clock::now();
+        if (!RasterImport::load(options.fuel_raster_path, options.density_raster_path,
+                                options.moisture_raster_path, &pool, imported.fuel, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        imported.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        options.scenario = "raster";
+        options.width = imported.fuel.getWidth();
+        options.height = imported.fuel.getHeight();
+        if (!checkIgnitionPoints(options, error) || !checkDenseSize(options, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        rasters = &imported;
+    }
+    
+    if (options.ensemble_members > 0) {
+        return runEnsemble(options, rasters);
+    }
+    if (options.ranks > 1) {
+        return runDecomposed(options, rasters);
+    }
+    if (options.tile_size > 0) {
+        return runTiled(options, rasters);
+    }
+    
+    FireSimulation sim(options.width, options.height, options.time_step);
+    sim.setThreadCount(options.threads);
+    if (options.restore_path.empty()) {
+        setupSimulation(sim, options, rasters);
+    } else {
+        std::string error;
+        if (!sim.loadSnapshot(options.restore_path, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+    if (options.engine == "arrival") {
+        return runArrival(sim, options, rasters);
+    }
+    const Grid& grid = sim.getGrid();
+    if (!options.record_path.empty()) {
+        std::string error;
+        if (!sim.startRecording(options.record_path, options.record_every, kDefaultKeyframeInterval, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    long steps = options.watch_every > 0 ? runWatched(sim, options)
+                                         : sim.runHeadless(options.max_steps, options.end_time);
+    double wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+    
+    std::string record_error;
+    bool recorded = sim.stopRecording(record_error);
+    
+    bool saved = options.output_path.empty() || sim.saveToFile(options.output_path);
+    std::string snapshot_error;
+    bool snapshot_saved = options.snapshot_out_path.empty() ||
+                          sim.saveSnapshot(options.snapshot_out_path, snapshot_error);
+    
+    double cell_updates = static_cast<double>(grid.getWidth()) * grid.getHeight() * steps;
+    std::cout << "{\"scenario\":" << jsonString(options.restore_path.empty() ? options.scenario : "restored")
+              << ",\"width\":" << grid.getWidth()
+              << ",\"height\":" << grid.getHeight()
+              << rasterFields(rasters)
+              << ",\"seed\":" << sim.getSeed()
+              << ",\"threads\":" << sim.getThreadCount()
+              << ",\"steps\":" << steps
+              << ",\"sim_time\":" << sim.getTotalTime()
+              << ",\"cells_burning\":" << sim.getCellsBurning()
+              << ",\"cells_burned\":" << sim.getCellsBurned()
+              << ",\"total_fuel_cells\":" << sim.getTotalFuelCells()
+              << ",\"burn_percentage\":" << sim.getBurnPercentage()
+              << ",\"wall_seconds\":" << wall_seconds
+              << ",\"cells_per_second\":" << (wall_seconds > 0.0 ? cell_updates / wall_seconds : 0.0);
+    if (!options.output_path.empty()) {
+        std::cout << ",\"output\":" << jsonString(options.output_path);
+    }
+    if (!options.restore_path.empty()) {
+        std::cout << ",\"restored_from\":" << jsonString(options.restore_path);
+    }
+    if (!options.snapshot_out_path.empty()) {
+        std::cout << ",\"snapshot\":" << jsonString(options.snapshot_out_path);
+    }
+    if (const FrameRecorder* recorder = sim.getRecorder()) {
+        std::cout << ",\"recording\":" << jsonString(options.record_path)
+                  << ",\"frames_written\":" << recorder->getFramesWritten()
+                  << ",\"frames_dropped\":" << recorder->getFramesDropped()
+                  << ",\"frames_stalled\":" << recorder->getFramesStalled();
+    }
+    std::cout << "}\n";
+    
+    if (!saved) {
+        std::cerr << "Could not write " << options.output_path << "\n";
+        return 1;
+    }
+    if (!snapshot_saved) {
+        std::cerr << "Error: " << snapshot_error << "\n";
+        return 1;
+    }
+    if (!recorded) {
+        std::cerr << "Error: " << record_error << "\n";
+        return 1;
+    }
+    return 0;
+}
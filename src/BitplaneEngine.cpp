@@ -0,0 +1,353 @@
+#include "BitplaneEngine.h"
+#include "Grid.h"
+#include "BurnKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+namespace {
+constexpr uint64_t kAlwaysFires = uint64_t(1) << 32;
+
+// Lanes of the thinning draws, after the 32 bit planes of every direction
+constexpr uint32_t kThinningLane = 32 * 32;
+}
+
+BitplaneEngine::BitplaneEngine() : attached(false), blocked_by_suppression(false), width(0), height(0),
+                                   row_words(0), fuel_type(0), fuel_density(0), moisture(0),
+                                   ignition_probability(0.0) {}
+
+BitplaneEngine::Cohort& BitplaneEngine::newCohort() {
+    if (spare_cohorts.empty()) {
+        cohorts.emplace_back();
+    } else {
+        cohorts.push_back(std::move(spare_cohorts.back()));
+        spare_cohorts.pop_back();
+    }
+    Cohort& cohort = cohorts.back();
+    cohort.words.clear();
+    cohort.bits.clear();
+    return cohort;
+}
+
+void BitplaneEngine::addBurning(const Cohort& cohort, bool burning) {
+    for (size_t j = 0; j < cohort.words.size(); ++j) {
+        int word = cohort.words[j];
+        int count = __builtin_popcountll(cohort.bits[j]);
+        if (burning) {
+            burning_plane[word] |= cohort.bits[j];
+            row_burning[word / row_words] += count;
+        } else {
+            burning_plane[word] &= ~cohort.bits[j];
+            row_burning[word / row_words] -= count;
+        }
+    }
+}
+
+bool BitplaneEngine::attach(const Grid& grid) {
+    attached = false;
+    blocked_by_suppression = false;
+    width = grid.width;
+    height = grid.height;
+    row_words = (width + 63) / 64;
+    fuel_plane.assign(static_cast<size_t>(row_words) * height, 0);
+    burning_plane.assign(fuel_plane.size(), 0);
+    ignite_plane.assign(fuel_plane.size(), 0);
+    row_burning.assign(height, 0);
+    ignite_words.clear();
+    for (Cohort& cohort : cohorts) {
+        spare_cohorts.push_back(std::move(cohort));
+    }
+    cohorts.clear();
+
+    // Any timed suppression blocks, even where its levels rounded to zero
+    if (!grid.suppression_ends.empty()) {
+        blocked_by_suppression = true;
+        return false;
+    }
+
+    // Burning cells that share their whole state advance identically, so they
+    // become one cohort
+    typedef std::tuple<uint8_t, uint8_t, uint8_t, int16_t, float> CohortKey;
+    std::map<CohortKey, size_t> cohort_of;
+    bool have_fuel = false;
+    uint16_t fuel_ignition = 0;     // Raw ignition cache of the uniform fuel
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int idx = grid.index(x, y);
+            if (grid.water_levels[idx] || grid.retardant_levels[idx]) {
+                blocked_by_suppression = true;
+                return false;
+            }
+
+            int word = y * row_words + x / 64;
+            uint64_t bit = uint64_t(1) << (x & 63);
+            CellState state = static_cast<CellState>(grid.states[idx]);
+            if (have_fuel && state == CellState::FUEL && grid.fuel_types[idx] == fuel_type &&
+                grid.fuel_densities[idx] == fuel_density && grid.moistures[idx] == moisture &&
+                grid.ignition_probabilities[idx] == fuel_ignition && !grid.firebreaks[idx]) {
+                // Same bytes as the first fuel cell, so it can burn too
+                fuel_plane[word] |= bit;
+            } else if (state == CellState::BURNING) {
+                CohortKey key(grid.fuel_types[idx], grid.fuel_densities[idx], grid.moistures[idx],
+                              grid.temperatures[idx], grid.burn_times[idx]);
+                auto found = cohort_of.find(key);
+                if (found == cohort_of.end()) {
+                    found = cohort_of.insert({key, cohorts.size()}).first;
+                    Cohort& cohort = newCohort();
+                    cohort.state = grid.states[idx];
+                    cohort.fuel_type = grid.fuel_types[idx];
+                    cohort.fuel_density = grid.fuel_densities[idx];
+                    cohort.moisture = grid.moistures[idx];
+                    cohort.temperature = grid.temperatures[idx];
+                    cohort.burn_time = grid.burn_times[idx];
+                }
+                Cohort& cohort = cohorts[found->second];
+                if (cohort.words.empty() || cohort.words.back() != word) {
+                    cohort.words.push_back(word);
+                    cohort.bits.push_back(0);
+                }
+                cohort.bits.back() |= bit;
+            } else if (grid.canBurnAt(idx) && !grid.firebreaks[idx]) {
+                // Every cell that can still ignite must have the same fuel
+                if (!have_fuel) {
+                    have_fuel = true;
+                    fuel_type = grid.fuel_types[idx];
+                    fuel_density = grid.fuel_densities[idx];
+                    moisture = grid.moistures[idx];
+                    fuel_ignition = grid.ignition_probabilities[idx];
+                    ignition_probability = grid.ignitionProbabilityAt(idx);
+                } else {
+                    return false;
+                }
+                fuel_plane[word] |= bit;
+            }
+        }
+    }
+
+    for (const Cohort& cohort : cohorts) {
+        addBurning(cohort, true);
+    }
+    attached = true;
+    return true;
+}
+
+uint64_t BitplaneEngine::drawThreshold(const Grid& grid, int direction_x, int direction_y,
+                                       int16_t temperature, double dt) const {
+    // A draw of 32 random bits fires below this value, the same test as
+    // draw < prob * dt in the general engine
+    double kernel = grid.spread_kernel[(direction_y + 2) * 5 + (direction_x + 2)];
+    double prob = grid.spreadProbability(ignition_probability, kernel, temperature, 0.0);
+    double scaled = prob * dt * 4294967296.0;
+    return scaled >= 4294967296.0 ? kAlwaysFires : static_cast<uint64_t>(std::ceil(scaled));
+}
+
+uint64_t BitplaneEngine::drawMask(uint64_t lanes, uint64_t threshold, uint64_t word_key, int direction) {
+    // Draws are compared with the threshold one bit plane at a time from the
+    // top, and a lane drops out at its first bit that differs from the
+    // threshold; about seven planes settle all 64 lanes
+    if (threshold == 0) return 0;
+    if (threshold >= kAlwaysFires) return lanes;
+
+    uint64_t undecided = lanes;
+    uint64_t fired = 0;
+    for (int level = 0; level < 32 && undecided; ++level) {
+        int bit = 31 - level;
+        // Lanes that matched every bit so far cannot get below a threshold whose remaining bits are zero
+        if ((threshold & ((uint64_t(2) << bit) - 1)) == 0) break;
+
+        uint64_t plane = CounterRng::bits64(word_key, CounterRng::BITPLANE,
+                                            static_cast<uint32_t>(direction * 32 + level));
+        if ((threshold >> bit) & 1) {
+            fired |= undecided & ~plane;
+            undecided &= plane;
+        } else {
+            undecided &= ~plane;
+        }
+    }
+    return fired;
+}
+
+void BitplaneEngine::scatter(int word, uint64_t fired, int dx, int dy) {
+    // Source lanes only fire into fuel, so shifted bits never leave their row
+    int target = word + dy * row_words;
+    uint64_t spill = 0;
+    int spill_word = target;
+    if (dx > 0) {
+        spill = fired >> (64 - dx);
+        fired <<= dx;
+        spill_word = target + 1;
+    } else if (dx < 0) {
+        spill = fired << (64 + dx);
+        fired >>= -dx;
+        spill_word = target - 1;
+    }
+
+    if (fired) {
+        if (!ignite_plane[target]) ignite_words.push_back(target);
+        ignite_plane[target] |= fired;
+    }
+    if (spill) {
+        if (!ignite_plane[spill_word]) ignite_words.push_back(spill_word);
+        ignite_plane[spill_word] |= spill;
+    }
+}
+
+void BitplaneEngine::writeCohorts(Grid& grid) {
+    // Row by row across all cohorts: cohorts interleave over the whole fire,
+    // and writing one cohort at a time would sweep the field arrays once each
+    cursors.assign(cohorts.size(), 0);
+    for (int y = 0; y < height; ++y) {
+        if (row_burning[y] == 0) continue;
+        int row_end = (y + 1) * row_words;
+        for (size_t c = 0; c < cohorts.size(); ++c) {
+            const Cohort& cohort = cohorts[c];
+            size_t& j = cursors[c];
+            for (; j < cohort.words.size() && cohort.words[j] < row_end; ++j) {
+                int word = cohort.words[j];
+                int base = grid.index((word % row_words) * 64, y);
+                for (uint64_t bits = cohort.bits[j]; bits; bits &= bits - 1) {
+                    int idx = base + __builtin_ctzll(bits);
+                    grid.temperatures[idx] = cohort.temperature;
+                    grid.burn_times[idx] = cohort.burn_time;
+                }
+                // State and density only change on ignition and burnout
+                if (state_changed[c]) {
+                    for (uint64_t bits = cohort.bits[j]; bits; bits &= bits - 1) {
+                        int idx = base + __builtin_ctzll(bits);
+                        grid.states[idx] = cohort.state;
+                        grid.fuel_densities[idx] = cohort.fuel_density;
+                        if (grid.change_log_enabled) grid.changed_cells.push_back(idx);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BitplaneEngine::update(Grid& grid, double dt) {
+    const StencilOffset* offsets;
+    int direction_count = getStencilOffsets(grid.spread_stencil, &offsets);
+
+    // Targets share one ignition probability and have no suppression, so a
+    // source's chance to spread depends only on the direction and its own
+    // temperature. The bitplane draw uses the hottest cohort's threshold for
+    // every source; the few sources that fire are then kept with probability
+    // (own threshold) / (hottest threshold), which gives each source exactly
+    // its own chance.
+    int16_t hottest = cohorts.empty() ? 0 : cohorts[0].temperature;
+    for (const Cohort& cohort : cohorts) {
+        hottest = std::max(hottest, cohort.temperature);
+    }
+    max_thresholds.resize(direction_count);
+    for (int d = 0; d < direction_count; ++d) {
+        max_thresholds[d] = drawThreshold(grid, offsets[d].dx, offsets[d].dy, hottest, dt);
+    }
+
+    for (int y = 0; y < height && !cohorts.empty(); ++y) {
+        if (row_burning[y] == 0) continue;
+        for (int k = 0; k < row_words; ++k) {
+            int word = y * row_words + k;
+            uint64_t sources = burning_plane[word];
+            if (!sources) continue;
+            uint64_t word_key = grid.rng.cellKey(grid.step_count, static_cast<uint32_t>(word));
+
+            for (int d = 0; d < direction_count; ++d) {
+                int dx = offsets[d].dx;
+                int dy = offsets[d].dy;
+                if (y + dy < 0 || y + dy >= height) continue;
+
+                // Fuel seen from each source lane in this direction
+                const uint64_t* row = &fuel_plane[static_cast<size_t>(y + dy) * row_words];
+                uint64_t targets = row[k];
+                if (dx > 0) {
+                    targets = (targets >> dx) | (k + 1 < row_words ? row[k + 1] << (64 - dx) : 0);
+                } else if (dx < 0) {
+                    targets = (targets << -dx) | (k > 0 ? row[k - 1] >> (64 + dx) : 0);
+                }
+
+                uint64_t lanes = sources & targets;
+                if (!lanes) continue;
+                uint64_t fired = drawMask(lanes, max_thresholds[d], word_key, d);
+
+                for (uint64_t bits = fired; bits; bits &= bits - 1) {
+                    int lane = __builtin_ctzll(bits);
+                    int idx = grid.index(k * 64 + lane, y);
+                    uint64_t own = drawThreshold(grid, dx, dy, grid.temperatures[idx], dt);
+                    if (own >= max_thresholds[d]) continue;
+                    uint64_t draw = static_cast<uint32_t>(CounterRng::bits64(
+                        word_key, CounterRng::BITPLANE, kThinningLane + static_cast<uint32_t>(d * 64 + lane)));
+                    if (draw * max_thresholds[d] >= own << 32) {
+                        fired &= ~(uint64_t(1) << lane);
+                    }
+                }
+                if (fired) {
+                    scatter(word, fired, dx, dy);
+                }
+            }
+        }
+    }
+
+    // Cells reached this step ignite together and form a new cohort, which
+    // advances by dt in this step like the general engine's ignitions
+    int ignited = 0;
+    if (!ignite_words.empty()) {
+        std::sort(ignite_words.begin(), ignite_words.end());
+        Cohort& cohort = newCohort();
+        cohort.state = static_cast<uint8_t>(CellState::BURNING);
+        cohort.fuel_type = fuel_type;
+        cohort.fuel_density = fuel_density;
+        cohort.moisture = moisture;
+        cohort.temperature = 3000;  // Initial fire temperature, tenths
+        cohort.burn_time = 0.0f;
+        for (int word : ignite_words) {
+            uint64_t bits = ignite_plane[word] & fuel_plane[word];
+            ignite_plane[word] = 0;
+            if (bits) {
+                fuel_plane[word] &= ~bits;
+                cohort.words.push_back(word);
+                cohort.bits.push_back(bits);
+                ignited += __builtin_popcountll(bits);
+            }
+        }
+        ignite_words.clear();
+        addBurning(cohort, true);
+    }
+
+    // Advance one representative per cohort and write it through to the cells
+    // (the new cohort, if any, is last)
+    state_changed.assign(cohorts.size(), 0);
+    if (ignited > 0) {
+        state_changed.back() = 1;
+    }
+    for (size_t c = 0; c < cohorts.size(); ++c) {
+        Cohort& cohort = cohorts[c];
+        BurnSpan span{&cohort.state, &cohort.fuel_type, &cohort.fuel_density, &cohort.moisture,
+                      &cohort.temperature, &cohort.burn_time, 1};
+        if (burnProgress(span, static_cast<float>(dt)) > 0) {
+            state_changed[c] = 1;
+        }
+    }
+    writeCohorts(grid);
+
+    int burned_out = 0;
+    size_t kept = 0;
+    for (size_t c = 0; c < cohorts.size(); ++c) {
+        Cohort& cohort = cohorts[c];
+        if (cohort.state == static_cast<uint8_t>(CellState::BURNED)) {
+            for (uint64_t bits : cohort.bits) {
+                burned_out += __builtin_popcountll(bits);
+            }
+            addBurning(cohort, false);
+            spare_cohorts.push_back(std::move(cohort));
+        } else {
+            if (kept != c) cohorts[kept] = std::move(cohort);
+            ++kept;
+        }
+    }
+    cohorts.resize(kept);
+
+    grid.burning_count += ignited - burned_out;
+    grid.burned_count += burned_out;
+}
@@ -0,0 +1,284 @@
+#include "BurnKernel.h"
+#include "Cell.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Built with -ffp-contract=off: AVX-512 implies FMA, and fusing the multiply-adds
+// would make the vector paths round differently from the scalar reference.
+#if defined(__x86_64__) || defined(__i386__)
+#define WILDFIRE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr uint8_t kBurning = static_cast<uint8_t>(CellState::BURNING);
+constexpr uint8_t kBurned = static_cast<uint8_t>(CellState::BURNED);
+
+// Burn duration in seconds by fuel type, as in Cell::update (8 entries so the
+// AVX2 path can look it up with a single register permute)
+alignas(32) const float kBurnDurations[8] = {
+    30.0f,  // GRASS
+    120.0f, // SHRUB
+    300.0f, // TREE
+    30.0f, 30.0f, 30.0f, 30.0f, 30.0f
+};
+
+int burnProgressScalar(const BurnSpan& span, int begin, float dt) {
+    int burnouts = 0;
+    for (int i = begin; i < span.count; ++i) {
+        if (span.states[i] != kBurning) continue;
+
+        float burn_time = span.burn_times[i] + dt;
+        float duration = kBurnDurations[span.fuel_types[i] & 7] * (span.fuel_densities[i] / 255.0f) *
+                         (1.0f + span.moistures[i] / 255.0f);
+        float temperature = 300.0f * (1.0f - burn_time / duration) + 20.0f;
+
+        if (burn_time >= duration) {
+            span.states[i] = kBurned;
+            span.fuel_densities[i] = 0;
+            temperature = 20.0f;
+            ++burnouts;
+        }
+
+        span.burn_times[i] = burn_time;
+        float tenths = std::nearbyint(temperature * 10.0f);
+        span.temperatures[i] = static_cast<int16_t>(std::min(32767.0f, std::max(-32768.0f, tenths)));
+    }
+    return burnouts;
+}
+
+#ifdef WILDFIRE_X86
+// Zero-extends 4 bytes to 32-bit lanes
+__attribute__((target("sse2")))
+inline __m128i widenBytesSse2(const uint8_t* src) {
+    int32_t raw;
+    std::memcpy(&raw, src, sizeof(raw));
+    __m128i zero = _mm_setzero_si128();
+    __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero);
+    return _mm_unpacklo_epi16(words, zero);
+}
+
+__attribute__((target("sse2")))
+inline __m128i selectSse2(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+__attribute__((target("sse2")))
+int burnProgressSse2(const BurnSpan& span, float dt) {
+    const __m128i burning = _mm_set1_epi32(kBurning);
+    const __m128 dt4 = _mm_set1_ps(dt);
+    const __m128 inv_scale = _mm_set1_ps(255.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    int burnouts = 0;
+    int i = 0;
+    for (; i + 4 <= span.count; i += 4) {
+        __m128i state = widenBytesSse2(span.states + i);
+        __m128i is_burning = _mm_cmpeq_epi32(state, burning);
+        if (_mm_movemask_epi8(is_burning) == 0) continue;
+
+        // SSE2 has no variable permute, so the table lookup is a select chain
+        __m128i fuel = _mm_and_si128(widenBytesSse2(span.fuel_types + i), _mm_set1_epi32(7));
+        __m128 duration = _mm_set1_ps(kBurnDurations[0]);
+        for (int f = 1; f < 8; ++f) {
+            __m128 match = _mm_castsi128_ps(_mm_cmpeq_epi32(fuel, _mm_set1_epi32(f)));
+            duration = _mm_or_ps(_mm_and_ps(match, _mm_set1_ps(kBurnDurations[f])),
+                                 _mm_andnot_ps(match, duration));
+        }
+
+        __m128i density = widenBytesSse2(span.fuel_densities + i);
+        __m128 density_f = _mm_div_ps(_mm_cvtepi32_ps(density), inv_scale);
+        __m128 moisture_f = _mm_div_ps(_mm_cvtepi32_ps(widenBytesSse2(span.moistures + i)), inv_scale);
+        duration = _mm_mul_ps(_mm_mul_ps(duration, density_f), _mm_add_ps(one, moisture_f));
+
+        __m128 old_burn_time = _mm_loadu_ps(span.burn_times + i);
+        __m128 burn_time = _mm_add_ps(old_burn_time, dt4);
+        __m128 temperature = _mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(300.0f), _mm_sub_ps(one, _mm_div_ps(burn_time, duration))),
+            _mm_set1_ps(20.0f));
+
+        __m128i burnout = _mm_and_si128(_mm_castps_si128(_mm_cmpge_ps(burn_time, duration)), is_burning);
+        burnouts += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(burnout)));
+        temperature = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(burnout), _mm_set1_ps(20.0f)),
+                                _mm_andnot_ps(_mm_castsi128_ps(burnout), temperature));
+        __m128i tenths = _mm_cvtps_epi32(_mm_mul_ps(temperature, _mm_set1_ps(10.0f)));
+
+        // Lanes that are not burning keep their old values
+        __m128i new_state = selectSse2(burnout, _mm_set1_epi32(kBurned), state);
+        __m128i new_density = selectSse2(burnout, _mm_setzero_si128(), density);
+        __m128 new_burn_time = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(is_burning), burn_time),
+                                         _mm_andnot_ps(_mm_castsi128_ps(is_burning), old_burn_time));
+        __m128i old_temps = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(span.temperatures + i));
+        old_temps = _mm_srai_epi32(_mm_unpacklo_epi16(old_temps, old_temps), 16);
+        __m128i new_temps = selectSse2(is_burning, tenths, old_temps);
+
+        _mm_storeu_ps(span.burn_times + i, new_burn_time);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(span.temperatures + i), _mm_packs_epi32(new_temps, new_temps));
+        __m128i bytes = _mm_packs_epi32(new_state, new_density);   // states in words 0-3, densities in 4-7
+        bytes = _mm_packus_epi16(bytes, bytes);
+        int32_t packed_states = _mm_cvtsi128_si32(bytes);
+        int32_t packed_densities = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 4));
+        std::memcpy(span.states + i, &packed_states, sizeof(packed_states));
+        std::memcpy(span.fuel_densities + i, &packed_densities, sizeof(packed_densities));
+    }
+
+    return burnouts + burnProgressScalar(span, i, dt);
+}
+
+__attribute__((target("avx2")))
+int burnProgressAvx2(const BurnSpan& span, float dt) {
+    const __m256i burning = _mm256_set1_epi32(kBurning);
+    const __m256 durations = _mm256_load_ps(kBurnDurations);
+    const __m256 dt8 = _mm256_set1_ps(dt);
+    const __m256 inv_scale = _mm256_set1_ps(255.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    int burnouts = 0;
+    int i = 0;
+    for (; i + 8 <= span.count; i += 8) {
+        __m256i state = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(span.states + i)));
+        __m256i is_burning = _mm256_cmpeq_epi32(state, burning);
+        if (_mm256_testz_si256(is_burning, is_burning)) continue;
+
+        __m256i fuel = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(span.fuel_types + i)));
+        __m256 duration = _mm256_permutevar8x32_ps(durations, fuel);
+
+        __m256i density = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(span.fuel_densities + i)));
+        __m256i moisture = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(span.moistures + i)));
+        __m256 density_f = _mm256_div_ps(_mm256_cvtepi32_ps(density), inv_scale);
+        __m256 moisture_f = _mm256_div_ps(_mm256_cvtepi32_ps(moisture), inv_scale);
+        duration = _mm256_mul_ps(_mm256_mul_ps(duration, density_f), _mm256_add_ps(one, moisture_f));
+
+        __m256 old_burn_time = _mm256_loadu_ps(span.burn_times + i);
+        __m256 burn_time = _mm256_add_ps(old_burn_time, dt8);
+        __m256 temperature = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_set1_ps(300.0f), _mm256_sub_ps(one, _mm256_div_ps(burn_time, duration))),
+            _mm256_set1_ps(20.0f));
+
+        __m256i burnout = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(burn_time, duration, _CMP_GE_OQ)),
+                                           is_burning);
+        burnouts += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(burnout)));
+        temperature = _mm256_blendv_ps(temperature, _mm256_set1_ps(20.0f), _mm256_castsi256_ps(burnout));
+        __m256i tenths = _mm256_cvtps_epi32(_mm256_mul_ps(temperature, _mm256_set1_ps(10.0f)));
+
+        // Lanes that are not burning keep their old values
+        __m256i new_state = _mm256_blendv_epi8(state, _mm256_set1_epi32(kBurned), burnout);
+        __m256i new_density = _mm256_blendv_epi8(density, _mm256_setzero_si256(), burnout);
+        __m256 new_burn_time = _mm256_blendv_ps(old_burn_time, burn_time, _mm256_castsi256_ps(is_burning));
+        __m256i old_temps = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(span.temperatures + i)));
+        __m256i new_temps = _mm256_blendv_epi8(old_temps, tenths, is_burning);
+
+        _mm256_storeu_ps(span.burn_times + i, new_burn_time);
+        __m128i temps16 = _mm_packs_epi32(_mm256_castsi256_si128(new_temps), _mm256_extracti128_si256(new_temps, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(span.temperatures + i), temps16);
+        __m128i states16 = _mm_packs_epi32(_mm256_castsi256_si128(new_state), _mm256_extracti128_si256(new_state, 1));
+        __m128i densities16 = _mm_packs_epi32(_mm256_castsi256_si128(new_density), _mm256_extracti128_si256(new_density, 1));
+        __m128i bytes = _mm_packus_epi16(states16, densities16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(span.states + i), bytes);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(span.fuel_densities + i), _mm_srli_si128(bytes, 8));
+    }
+
+    return burnouts + burnProgressScalar(span, i, dt);
+}
+
+// GCC's AVX-512 headers self-initialize their "undefined" placeholder vectors,
+// which trips -Wmaybe-uninitialized when the ISA comes from a target attribute
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+int burnProgressAvx512(const BurnSpan& span, float dt) {
+    const __m512i burning = _mm512_set1_epi32(kBurning);
+    const __m512 durations = _mm512_castps256_ps512(_mm256_load_ps(kBurnDurations));
+    const __m512 dt16 = _mm512_set1_ps(dt);
+    const __m512 inv_scale = _mm512_set1_ps(255.0f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+
+    int burnouts = 0;
+    int i = 0;
+    for (; i + 16 <= span.count; i += 16) {
+        __m512i state = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(span.states + i)));
+        __mmask16 is_burning = _mm512_cmpeq_epi32_mask(state, burning);
+        if (is_burning == 0) continue;
+
+        __m512i fuel = _mm512_and_si512(
+            _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(span.fuel_types + i))),
+            _mm512_set1_epi32(7));
+        __m512 duration = _mm512_permutexvar_ps(fuel, durations);
+
+        __m512i density = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(span.fuel_densities + i)));
+        __m512i moisture = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(span.moistures + i)));
+        __m512 density_f = _mm512_div_ps(_mm512_cvtepi32_ps(density), inv_scale);
+        __m512 moisture_f = _mm512_div_ps(_mm512_cvtepi32_ps(moisture), inv_scale);
+        duration = _mm512_mul_ps(_mm512_mul_ps(duration, density_f), _mm512_add_ps(one, moisture_f));
+
+        __m512 burn_time = _mm512_add_ps(_mm512_loadu_ps(span.burn_times + i), dt16);
+        __m512 temperature = _mm512_add_ps(
+            _mm512_mul_ps(_mm512_set1_ps(300.0f), _mm512_sub_ps(one, _mm512_div_ps(burn_time, duration))),
+            _mm512_set1_ps(20.0f));
+
+        __mmask16 burnout = _mm512_mask_cmp_ps_mask(is_burning, burn_time, duration, _CMP_GE_OQ);
+        burnouts += __builtin_popcount(burnout);
+        temperature = _mm512_mask_blend_ps(burnout, temperature, _mm512_set1_ps(20.0f));
+        __m512i tenths = _mm512_cvtps_epi32(_mm512_mul_ps(temperature, _mm512_set1_ps(10.0f)));
+
+        // Masked stores leave cells that are not burning untouched
+        _mm512_mask_storeu_ps(span.burn_times + i, is_burning, burn_time);
+        _mm512_mask_cvtsepi32_storeu_epi16(span.temperatures + i, is_burning, tenths);
+        _mm512_mask_cvtepi32_storeu_epi8(span.states + i, burnout, _mm512_set1_epi32(kBurned));
+        _mm512_mask_cvtepi32_storeu_epi8(span.fuel_densities + i, burnout, _mm512_setzero_si512());
+    }
+
+    return burnouts + burnProgressScalar(span, i, dt);
+}
+#pragma GCC diagnostic pop
+#endif
+
+BurnKernelIsa detectIsa() {
+#ifdef WILDFIRE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return BurnKernelIsa::AVX512;
+    if (__builtin_cpu_supports("avx2")) return BurnKernelIsa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return BurnKernelIsa::SSE2;
+#endif
+    return BurnKernelIsa::SCALAR;
+}
+}
+
+BurnKernelIsa getBurnKernelIsa() {
+    static const BurnKernelIsa isa = detectIsa();
+    return isa;
+}
+
+bool isBurnKernelIsaSupported(BurnKernelIsa isa) {
+    return static_cast<int>(isa) <= static_cast<int>(getBurnKernelIsa());
+}
+
+const char* getBurnKernelIsaName(BurnKernelIsa isa) {
+    switch (isa) {
+        case BurnKernelIsa::SCALAR: return "scalar";
+        case BurnKernelIsa::SSE2: return "sse2";
+        case BurnKernelIsa::AVX2: return "avx2";
+        case BurnKernelIsa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+int burnProgress(const BurnSpan& span, float dt) {
+    return burnProgress(span, dt, getBurnKernelIsa());
+}
+
+int burnProgress(const BurnSpan& span, float dt, BurnKernelIsa isa) {
+    if (!isBurnKernelIsaSupported(isa)) {
+        isa = getBurnKernelIsa();
+    }
+
+    switch (isa) {
+#ifdef WILDFIRE_X86
+        case BurnKernelIsa::AVX512: return burnProgressAvx512(span, dt);
+        case BurnKernelIsa::AVX2: return burnProgressAvx2(span, dt);
+        case BurnKernelIsa::SSE2: return burnProgressSse2(span, dt);
+#endif
+        default: return burnProgressScalar(span, 0, dt);
+    }
+}
@@ -84,7 +84,7 @@ double Cell::getIgnitionProbability() const {
     return std::min(1.0, std::max(0.0, base_prob));
 }
 
-char Cell::getDisplayChar() const {
+char Cell::getDisplayChar(CellState state, FuelType fuel_type) {
     switch (state) {
         case CellState::EMPTY:
             if (fuel_type == FuelType::WATER) return '~';
@@ -0,0 +1,395 @@
+#include "DomainDecomposition.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+namespace {
+
+constexpr size_t kPageBytes = 4096;
+
+size_t alignUp(size_t bytes) {
+    return (bytes + kPageBytes - 1) / kPageBytes * kPageBytes;
+}
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct HaloCell {
+    int16_t temperature;
+    uint8_t state;
+    uint8_t unused;
+};
+
+// Written by its rank only, read by the other ranks after the barrier and by
+// the coordinator once the rank has exited
+struct alignas(64) RankSlot {
+    int32_t burning[2];         // Published with the strips, by step parity
+    int32_t final_burning;      // Counts after the last step
+    int32_t final_burned;
+    int32_t final_fuel;
+    int64_t steps;
+    double sim_time;
+    double step_seconds;
+    double wait_seconds;
+    char error[128];
+};
+
+// A rank's halo: landscape cells within reach of it, at their position
+// relative to it, and where their owner publishes them for each parity
+struct HaloLink {
+    const HaloCell* cells[2];
+    int x, y;
+};
+
+} // namespace
+
+DomainDecomposition::DomainDecomposition(double dt)
+    : columns(0), rows(0), time_step(dt), steps(0), sim_time(0.0),
+      cells_burning(0), cells_burned(0), total_fuel_cells(0) {
+}
+
+bool DomainDecomposition::partition(int width, int height, int ranks, std::string& error) {
+    const int kMinSide = 2 * Grid::kHalo;
+    int best_columns = 0;
+    long best_cut = 0;
+    for (int c = 1; c <= ranks; ++c) {
+        if (ranks % c != 0) continue;
+        int r = ranks / c;
+        if (width / c < kMinSide || height / r < kMinSide) continue;
+        long cut = static_cast<long>(c - 1) * height + static_cast<long>(r - 1) * width;
+        if (best_columns == 0 || cut < best_cut) {
+            best_columns = c;
+            best_cut = cut;
+        }
+    }
+    if (best_columns == 0) {
+        error = "a " + std::to_string(width) + "x" + std::to_string(height) + " grid cannot be split into " +
+                std::to_string(ranks) + " subdomains of at least " + std::to_string(kMinSide) + " cells a side";
+        return false;
+    }
+
+    columns = best_columns;
+    rows = ranks / best_columns;
+    x_bounds.resize(columns + 1);
+    y_bounds.resize(rows + 1);
+    for (int c = 0; c <= columns; ++c) {
+        x_bounds[c] = static_cast<int>(static_cast<long>(width) * c / columns);
+    }
+    for (int r = 0; r <= rows; ++r) {
+        y_bounds[r] = static_cast<int>(static_cast<long>(height) * r / rows);
+    }
+
+    // Each rank steps its subdomain as one dense Grid
+    int widest = 0, tallest = 0;
+    for (int c = 0; c < columns; ++c) widest = std::max(widest, x_bounds[c + 1] - x_bounds[c]);
+    for (int r = 0; r < rows; ++r) tallest = std::max(tallest, y_bounds[r + 1] - y_bounds[r]);
+    if (!Grid::fitsIndex(widest, tallest)) {
+        error = "a " + std::to_string(widest) + "x" + std::to_string(tallest) +
+                " subdomain is too large for a dense grid; use more ranks";
+        columns = rows = 0;
+        return false;
+    }
+    return true;
+}
+
+Subdomain DomainDecomposition::getSubdomain(int rank) const {
+    int c = rank % columns;
+    int r = rank / columns;
+    return Subdomain{x_bounds[c], y_bounds[r], x_bounds[c + 1] - x_bounds[c], y_bounds[r + 1] - y_bounds[r]};
+}
+
+int DomainDecomposition::ownerOf(int x, int y) const {
+    int c = static_cast<int>(std::upper_bound(x_bounds.begin(), x_bounds.end(), x) - x_bounds.begin()) - 1;
+    int r = static_cast<int>(std::upper_bound(y_bounds.begin(), y_bounds.end(), y) - y_bounds.begin()) - 1;
+    return r * columns + c;
+}
+
+int DomainDecomposition::stripCells(const Subdomain& area) {
+    const int k = Grid::kHalo;
+    return 2 * k * area.width + (area.height - 2 * k) * 2 * k;
+}
+
+int DomainDecomposition::stripOffset(const Subdomain& area, int x, int y) {
+    const int k = Grid::kHalo;
+    if (y < k) return y * area.width + x;
+    if (y >= area.height - k) return (y - area.height + 2 * k) * area.width + x;
+    int column = x < k ? x : x - area.width + 2 * k;
+    return 2 * k * area.width + (y - k) * 2 * k + column;
+}
+
+// One segment: the barrier and the rank slots in the first pages, then both
+// strip buffers of each rank on pages of their own, so they are first
+// touched by the rank that writes them
+struct DomainDecomposition::SharedLayout {
+    size_t slots;
+    std::vector<size_t> strips;
+    size_t bytes;
+};
+
+DomainDecomposition::SharedLayout DomainDecomposition::sharedLayout() const {
+    int ranks = getRankCount();
+    SharedLayout layout;
+    layout.slots = alignUp(sizeof(pthread_barrier_t));
+    size_t offset = alignUp(layout.slots + sizeof(RankSlot) * ranks);
+    for (int rank = 0; rank < ranks; ++rank) {
+        Subdomain area = getSubdomain(rank);
+        layout.strips.push_back(offset);
+        offset = alignUp(offset + 2 * sizeof(HaloCell) * stripCells(area));
+    }
+    layout.bytes = offset;
+    return layout;
+}
+
+void DomainDecomposition::buildSubdomain(const Landscape& landscape, const Subdomain& area, Grid& grid) const {
+    // As TiledGrid::materialize builds a tile
+    grid.origin_x = area.x0;
+    grid.origin_y = area.y0;
+    grid.landscape_width = landscape.fuel.getWidth();
+    grid.rng.setSeed(landscape.seed);
+    grid.wind_speed = landscape.wind_speed;
+    grid.wind_direction = landscape.wind_direction;
+    grid.ambient_temp = landscape.ambient_temp;
+    grid.humidity = landscape.humidity;
+    grid.spread_stencil = landscape.spread_stencil;
+    grid.update_mode = landscape.update_mode == UpdateMode::BITPLANE ? UpdateMode::ACTIVE_FRONT
+                                                                     : landscape.update_mode;
+    landscape.fuel.fill(grid, area.x0, area.y0);
+    grid.rebuildDerivedState();
+
+    for (const auto& point : landscape.ignition_points) {
+        int x = point.first - area.x0;
+        int y = point.second - area.y0;
+        if (grid.isValidPosition(x, y)) {
+            grid.igniteCell(x, y);
+        }
+    }
+}
+
+void DomainDecomposition::runRank(int rank, const Landscape& landscape, long max_steps, double end_time,
+                                  char* shared) const {
+    const int k = Grid::kHalo;
+    int ranks = getRankCount();
+    SharedLayout layout = sharedLayout();
+    pthread_barrier_t* barrier = reinterpret_cast<pthread_barrier_t*>(shared);
+    RankSlot* slots = reinterpret_cast<RankSlot*>(shared + layout.slots);
+    RankSlot& slot = slots[rank];
+
+    Subdomain area = getSubdomain(rank);
+    Grid grid(area.width, area.height);
+    buildSubdomain(landscape, area, grid);
+
+    std::vector<HaloLink> links;
+    int landscape_width = landscape.fuel.getWidth();
+    int landscape_height = landscape.fuel.getHeight();
+    for (int y = area.y0 - k; y < area.y0 + area.height + k; ++y) {
+        bool own_row = y >= area.y0 && y < area.y0 + area.height;
+        for (int x = area.x0 - k; x < area.x0 + area.width + k; ++x) {
+            if (own_row && x == area.x0) x = area.x0 + area.width;   // Skip the rank's own cells
+            if (x < 0 || y < 0 || x >= landscape_width || y >= landscape_height) continue;
+            int owner = ownerOf(x, y);
+            if (owner == rank) continue;
+            Subdomain owner_area = getSubdomain(owner);
+            const HaloCell* owner_strips = reinterpret_cast<const HaloCell*>(shared + layout.strips[owner]);
+            const HaloCell* cell = owner_strips + stripOffset(owner_area, x - owner_area.x0, y - owner_area.y0);
+            links.push_back(HaloLink{{cell, cell + stripCells(owner_area)}, x - area.x0, y - area.y0});
+        }
+    }
+
+    int strip_cells = stripCells(area);
+    HaloCell* strips = reinterpret_cast<HaloCell*>(shared + layout.strips[rank]);
+    auto publish = [&](int x, int y, HaloCell* strip) {
+        int idx = grid.index(x, y);
+        strip[stripOffset(area, x, y)] = HaloCell{grid.temperatures[idx], grid.states[idx], 0};
+    };
+
+    double end_limit = end_time - time_step * 0.5;
+    double total_time = 0.0;
+    double step_total = 0.0;
+    double wait_total = 0.0;
+    long taken = 0;
+    while (true) {
+        double wait_start = now();
+        int parity = static_cast<int>(taken & 1);
+        HaloCell* strip = strips + parity * strip_cells;
+        for (int y = 0; y < area.height; ++y) {
+            bool full_row = y < k || y >= area.height - k;
+            for (int x = 0; x < area.width; ++x) {
+                if (!full_row && x == k) x = area.width - k;
+                publish(x, y, strip);
+            }
+        }
+        slot.burning[parity] = grid.getBurningCount();
+        pthread_barrier_wait(barrier);
+
+        // Every rank sees the same counts, so all of them stop at the same step
+        long burning = 0;
+        for (int other = 0; other < ranks; ++other) {
+            burning += slots[other].burning[parity];
+        }
+        if (burning == 0 || (max_steps >= 0 && taken >= max_steps) ||
+            (end_time >= 0 && total_time >= end_limit)) {
+            wait_total += now() - wait_start;
+            break;
+        }
+
+        grid.halo_sources.clear();
+        for (const HaloLink& link : links) {
+            const HaloCell& cell = *link.cells[parity];
+            if (static_cast<CellState>(cell.state) == CellState::BURNING) {
+                grid.halo_sources.push_back(Grid::HaloSource{link.x, link.y, cell.temperature});
+            }
+        }
+        double step_start = now();
+        wait_total += step_start - wait_start;
+
+        grid.update(time_step);
+        total_time += time_step;
+        ++taken;
+        step_total += now() - step_start;
+    }
+
+    slot.final_burning = grid.getBurningCount();
+    slot.final_burned = grid.getBurnedCount();
+    slot.final_fuel = grid.getFuelCellCount();
+    slot.steps = taken;
+    slot.sim_time = total_time;
+    slot.step_seconds = step_total;
+    slot.wait_seconds = wait_total;
+}
+
+bool DomainDecomposition::run(const Landscape& landscape, long max_steps, double end_time, std::string& error) {
+    int ranks = getRankCount();
+    if (ranks == 0 || x_bounds.back() != landscape.fuel.getWidth() ||
+        y_bounds.back() != landscape.fuel.getHeight()) {
+        error = "the landscape does not match the partitioned size";
+        return false;
+    }
+
+    // The segment is unlinked as soon as it is mapped; the ranks inherit the mapping
+    static std::atomic<int> segment_counter(0);
+    std::string name = "/wildfire-" + std::to_string(getpid()) + "-" + std::to_string(segment_counter++);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        error = "cannot create shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    SharedLayout layout = sharedLayout();
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(layout.bytes)) == 0) {
+        mapped = mmap(nullptr, layout.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int map_errno = errno;
+    shm_unlink(name.c_str());
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "cannot map " + std::to_string(layout.bytes) + " bytes of shared memory: " + std::strerror(map_errno);
+        return false;
+    }
+    char* shared = static_cast<char*>(mapped);
+
+    pthread_barrierattr_t attributes;
+    pthread_barrierattr_init(&attributes);
+    pthread_barrierattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_t* barrier = reinterpret_cast<pthread_barrier_t*>(shared);
+    pthread_barrier_init(barrier, &attributes, static_cast<unsigned>(ranks));
+    pthread_barrierattr_destroy(&attributes);
+    RankSlot* slots = reinterpret_cast<RankSlot*>(shared + layout.slots);
+
+    // Buffered output would otherwise be written again by every rank
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    std::vector<pid_t> pids;
+    for (int rank = 0; rank < ranks && error.empty(); ++rank) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int status = 0;
+            try {
+                runRank(rank, landscape, max_steps, end_time, shared);
+            } catch (const std::exception& e) {
+                std::snprintf(slots[rank].error, sizeof(slots[rank].error), "%s", e.what());
+                status = 1;
+            }
+            _exit(status);
+        }
+        if (pid < 0) {
+            error = std::string("cannot start a rank: ") + std::strerror(errno);
+        } else {
+            pids.push_back(pid);
+        }
+    }
+
+    // A rank that dies leaves the others waiting at the barrier, so the first
+    // failure stops them all
+    size_t running = pids.size();
+    if (!error.empty()) {
+        for (pid_t pid : pids) kill(pid, SIGKILL);
+    }
+    while (running > 0) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        auto found = std::find(pids.begin(), pids.end(), pid);
+        if (found == pids.end()) continue;
+        --running;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) continue;
+        if (error.empty()) {
+            int rank = static_cast<int>(found - pids.begin());
+            if (WIFEXITED(status)) {
+                error = "rank " + std::to_string(rank) + " failed: " + slots[rank].error;
+            } else {
+                error = "rank " + std::to_string(rank) + " was stopped by signal " +
+                        std::to_string(WTERMSIG(status));
+            }
+            for (pid_t other : pids) kill(other, SIGKILL);
+        }
+    }
+
+    if (error.empty()) {
+        steps = slots[0].steps;
+        sim_time = slots[0].sim_time;
+        cells_burning = 0;
+        cells_burned = 0;
+        total_fuel_cells = 0;
+        step_seconds.assign(ranks, 0.0);
+        wait_seconds.assign(ranks, 0.0);
+        for (int rank = 0; rank < ranks; ++rank) {
+            const RankSlot& slot = slots[rank];
+            cells_burning += slot.final_burning;
+            cells_burned += slot.final_burned;
+            total_fuel_cells += slot.final_fuel;
+            step_seconds[rank] = slot.step_seconds;
+            wait_seconds[rank] = slot.wait_seconds;
+        }
+    }
+
+    // A killed rank may have left the barrier mid-wait, which destroy would wait out
+    if (error.empty()) {
+        pthread_barrier_destroy(barrier);
+    }
+    munmap(mapped, layout.bytes);
+    return error.empty();
+}
+
+double DomainDecomposition::getBurnPercentage() const {
+    if (total_fuel_cells == 0) return 0.0;
+    return (double)(cells_burned + cells_burning) / total_fuel_cells * 100.0;
+}
+
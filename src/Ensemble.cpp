@@ -0,0 +1,128 @@
+#include "Ensemble.h"
+#include "FireSimulation.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+Ensemble::Ensemble(const Grid& initial, double dt)
+    : initial_grid(initial), time_step(dt), thread_pool(new ThreadPool(1)), member_count(0) {
+    initial_grid.setThreadPool(nullptr);
+    
+    size_t cell_count = static_cast<size_t>(initial_grid.getWidth()) * initial_grid.getHeight();
+    burn_counts.reset(new std::atomic<uint32_t>[cell_count]);
+    for (size_t i = 0; i < cell_count; ++i) {
+        burn_counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Ensemble::setThreadCount(int threads) {
+    thread_pool.reset(new ThreadPool(std::max(1, threads)));
+}
+
+uint64_t Ensemble::memberSeed(uint64_t seed, int member) {
+    // SplitMix64 finalizer, so neighbouring members get unrelated keys
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (static_cast<uint64_t>(member) + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void Ensemble::run(int members, uint64_t seed, long max_steps, double end_time) {
+    int width = initial_grid.getWidth();
+    int height = initial_grid.getHeight();
+    size_t cell_count = static_cast<size_t>(width) * height;
+    
+    member_count = std::max(0, members);
+    burn_percentages.assign(member_count, 0.0);
+    for (size_t i = 0; i < cell_count; ++i) {
+        burn_counts[i].store(0, std::memory_order_relaxed);
+    }
+    
+    // One task per thread; each pulls member indices until none are left and
+    // reuses its simulation, so the working grid is allocated once per thread
+    std::atomic<int> next_member(0);
+    int tasks = std::min(thread_pool->getThreadCount(), std::max(1, member_count));
+    thread_pool->parallelFor(tasks, [&](int) {
+        FireSimulation sim(width, height, time_step);
+        
+        // The terrain is copied into the working grid once; later members
+        // only copy back the fields a run changed
+        bool loaded = false;
+        for (int member = next_member++; member < member_count; member = next_member++) {
+            if (loaded) {
+                sim.reloadGrid(initial_grid);
+            } else {
+                sim.loadGrid(initial_grid);
+                loaded = true;
+            }
+            sim.setSeed(memberSeed(seed, member));
+            sim.runHeadless(max_steps, end_time);
+            burn_percentages[member] = sim.getBurnPercentage();
+            
+            const Grid& grid = sim.getGrid();
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    CellState state = grid.getCellState(x, y);
+                    if (state == CellState::BURNING || state == CellState::BURNED) {
+                        burn_counts[static_cast<size_t>(y) * width + x].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+    });
+    
+    sorted_percentages = burn_percentages;
+    std::sort(sorted_percentages.begin(), sorted_percentages.end());
+}
+
+uint32_t Ensemble::getBurnCount(int x, int y) const {
+    if (!initial_grid.isValidPosition(x, y)) return 0;
+    return burn_counts[static_cast<size_t>(y) * initial_grid.getWidth() + x].load(std::memory_order_relaxed);
+}
+
+double Ensemble::getBurnProbability(int x, int y) const {
+    if (member_count == 0) return 0.0;
+    return static_cast<double>(getBurnCount(x, y)) / member_count;
+}
+
+double Ensemble::getMeanBurnPercentage() const {
+    if (burn_percentages.empty()) return 0.0;
+    double sum = 0.0;
+    for (double percentage : burn_percentages) {
+        sum += percentage;
+    }
+    return sum / burn_percentages.size();
+}
+
+double Ensemble::getBurnPercentageQuantile(double q) const {
+    if (sorted_percentages.empty()) return 0.0;
+    q = std::max(0.0, std::min(1.0, q));
+    double position = q * (sorted_percentages.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(position));
+    size_t upper = std::min(lower + 1, sorted_percentages.size() - 1);
+    double fraction = position - lower;
+    return sorted_percentages[lower] + (sorted_percentages[upper] - sorted_percentages[lower]) * fraction;
+}
+
+bool Ensemble::saveProbabilityRaster(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+    
+    int width = initial_grid.getWidth();
+    int height = initial_grid.getHeight();
+    file << "ncols " << width << "\n";
+    file << "nrows " << height << "\n";
+    file << "xllcorner 0\n";
+    file << "yllcorner 0\n";
+    file << "cellsize 1\n";
+    file << "NODATA_value -9999\n";
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (x > 0) file << ' ';
+            file << getBurnProbability(x, y);
+        }
+        file << "\n";
+    }
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,29 @@
+#include "FalloffKernel.h"
+#include <cmath>
+
+FalloffKernel::FalloffKernel(int kernel_radius) : radius(kernel_radius) {
+    half_widths.resize(2 * radius + 1);
+    row_centers.resize(2 * radius + 1);
+    for (int dy = -radius; dy <= radius; ++dy) {
+        // Widest dx with dx^2 + dy^2 <= radius^2
+        int half = 0;
+        while ((half + 1) * (half + 1) + dy * dy <= radius * radius) ++half;
+        half_widths[dy + radius] = half;
+        row_centers[dy + radius] = static_cast<int>(factors.size()) + half;
+        for (int dx = -half; dx <= half; ++dx) {
+            // Same expression as the per-drop loop this replaces, so levels match bit for bit
+            double distance = sqrt(dx*dx + dy*dy);
+            factors.push_back(radius > 0 ? 1.0 - (distance / radius) : 1.0);
+        }
+    }
+}
+
+const FalloffKernel& FalloffKernelCache::get(int radius) {
+    if (radius >= static_cast<int>(kernels.size())) {
+        kernels.resize(radius + 1);
+    }
+    if (!kernels[radius]) {
+        kernels[radius] = std::make_shared<const FalloffKernel>(radius);
+    }
+    return *kernels[radius];
+}
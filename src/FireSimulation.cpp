@@ -1,12 +1,40 @@
 #include "FireSimulation.h"
+#include "Snapshot.h"
+#include "TerminalRenderer.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
 
 FireSimulation::FireSimulation(int width, int height, double dt) 
-    : grid(width, height), time_step(dt), total_time(0.0), running(false),
-      cells_burning(0), cells_burned(0), total_fuel_cells(0) {
+    : grid(width, height), thread_pool(new ThreadPool(1)), time_step(dt), total_time(0.0),
+      running(false), cells_burning(0), cells_burned(0), total_fuel_cells(0) {
+    grid.setThreadPool(thread_pool.get());
+    grid.setChangeLogEnabled(true);
+    human_manager.setSuppressionQueue(&suppression_queue);
+}
+
+void FireSimulation::setThreadCount(int threads) {
+    thread_pool.reset(new ThreadPool(std::max(1, threads)));
+    grid.setThreadPool(thread_pool.get());
+}
+
+void FireSimulation::loadGrid(const Grid& initial) {
+    grid = initial;
+    grid.setThreadPool(thread_pool.get());
+    grid.setChangeLogEnabled(true);
+    human_manager.invalidateDanger();
+    reset();
+}
+
+void FireSimulation::reloadGrid(const Grid& initial) {
+    grid.resetTo(initial);
+    grid.setChangeLogEnabled(true);
+    human_manager.invalidateDanger();
+    reset();
 }
 
 void FireSimulation::start() {
@@ -28,16 +56,24 @@ void FireSimulation::reset() {
 
 void FireSimulation::step() {
     if (running) {
+        suppression_queue.apply(grid);
         grid.update(time_step);
+        human_manager.updateDanger(grid);
+        grid.clearChangedCells();
         human_manager.updateCrews(time_step);
         human_manager.updateEvacuations(time_step);
         total_time += time_step;
         updateStatistics();
+        if (recorder && recorder->isOpen()) {
+            recorder->onStep(grid, human_manager, total_time);
+        }
     }
 }
 
 void FireSimulation::run(double duration) {
     start();
+    TerminalRenderer renderer;
+    std::ostringstream status;
     
     auto start_time = std::chrono::steady_clock::now();
     double elapsed = 0.0;
@@ -47,18 +83,16 @@ void FireSimulation::run(double duration) {
         
         // Check if fire has burned out
         if (cells_burning == 0) {
-            std::cout << "Fire has burned out after " << total_time << " seconds.\n";
             break;
         }
         
         // Update display every 10 steps
         static int step_count = 0;
         if (++step_count % 10 == 0) {
-            system("clear"); // Unix/Linux/Mac
-            // system("cls"); // Windows alternative
-            printStatus();
-            human_manager.printStatus();
-            grid.displayWithCrews(human_manager);
+            status.str("");
+            printStatus(status);
+            human_manager.printStatus(status);
+            renderer.render(grid, human_manager, status.str(), std::cout);
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         
@@ -66,30 +100,46 @@ void FireSimulation::run(double duration) {
         elapsed = std::chrono::duration<double>(current_time - start_time).count();
     }
     
+    renderer.finish(std::cout);
+    if (cells_burning == 0) {
+        std::cout << "Fire has burned out after " << total_time << " seconds.\n";
+    }
+    stop();
+}
+
+long FireSimulation::runHeadless(long max_steps, double end_time) {
+    start();
+    
+    // Half a step of slack so accumulated rounding in total_time does not add an extra step
+    double end_limit = end_time - time_step * 0.5;
+    long steps = 0;
+    while (running && cells_burning > 0 &&
+           (max_steps < 0 || steps < max_steps) &&
+           (end_time < 0 || total_time < end_limit)) {
+        step();
+        ++steps;
+    }
+    
     stop();
+    return steps;
 }
 
 void FireSimulation::updateStatistics() {
-    cells_burning = 0;
-    cells_burned = 0;
-    total_fuel_cells = 0;
+    // Grid keeps these counts up to date as cells change state
+    cells_burning = grid.getBurningCount();
+    cells_burned = grid.getBurnedCount();
+    total_fuel_cells = grid.getFuelCellCount();
     
-    for (int y = 0; y < grid.getHeight(); ++y) {
-        for (int x = 0; x < grid.getWidth(); ++x) {
-            const Cell& cell = grid.getCell(x, y);
-            
-            if (cell.canBurn() || cell.getState() == CellState::BURNING || 
-                cell.getState() == CellState::BURNED) {
-                total_fuel_cells++;
-            }
-            
-            if (cell.getState() == CellState::BURNING) {
-                cells_burning++;
-            } else if (cell.getState() == CellState::BURNED) {
-                cells_burned++;
-            }
-        }
+#ifdef WILDFIRE_CHECK_STATISTICS
+    int burning, burned, fuel;
+    grid.countCells(burning, burned, fuel);
+    if (burning != cells_burning || burned != cells_burned || fuel != total_fuel_cells) {
+        std::cerr << "Statistics out of sync after " << total_time << "s: burning "
+                  << cells_burning << "/" << burning << ", burned " << cells_burned << "/" << burned
+                  << ", fuel " << total_fuel_cells << "/" << fuel << "\n";
+        std::abort();
     }
+#endif
 }
 
 double FireSimulation::getBurnPercentage() const {
@@ -100,7 +150,7 @@ double FireSimulation::getBurnPercentage() const {
 void FireSimulation::setupGrassland() {
     for (int y = 0; y < grid.getHeight(); ++y) {
         for (int x = 0; x < grid.getWidth(); ++x) {
-            grid.getCell(x, y) = Cell(FuelType::GRASS, 0.8, 0.2);
+            grid.setCell(x, y, Cell(FuelType::GRASS, 0.8, 0.2));
         }
     }
 }
@@ -108,7 +158,7 @@ void FireSimulation::setupGrassland() {
 void FireSimulation::setupForest() {
     for (int y = 0; y < grid.getHeight(); ++y) {
         for (int x = 0; x < grid.getWidth(); ++x) {
-            grid.getCell(x, y) = Cell(FuelType::TREE, 0.9, 0.3);
+            grid.setCell(x, y, Cell(FuelType::TREE, 0.9, 0.3));
         }
     }
 }
@@ -117,6 +167,10 @@ void FireSimulation::setupMixed() {
     grid.initializeRandom();
 }
 
+void FireSimulation::setupProcedural() {
+    grid.initializeProcedural();
+}
+
 void FireSimulation::addFirebreak(int x1, int y1, int x2, int y2) {
     // Simple line drawing algorithm
     int dx = abs(x2 - x1);
@@ -132,7 +186,7 @@ void FireSimulation::addFirebreak(int x1, int y1, int x2, int y2) {
     
     while (true) {
         if (grid.isValidPosition(x, y)) {
-            grid.getCell(x, y) = Cell(FuelType::ROCK, 0.0, 0.0);
+            grid.setCell(x, y, Cell(FuelType::ROCK, 0.0, 0.0));
         }
         
         if (x == x2 && y == y2) break;
@@ -151,22 +205,22 @@ void FireSimulation::addIgnitionPoint(int x, int y) {
     grid.igniteCell(x, y);
 }
 
-void FireSimulation::printStatus() const {
-    std::cout << "=== Wildfire Simulation Status ===\n";
-    std::cout << "Time: " << total_time << "s\n";
-    std::cout << "Cells burning: " << cells_burning << "\n";
-    std::cout << "Cells burned: " << cells_burned << "\n";
-    std::cout << "Burn percentage: " << getBurnPercentage() << "%\n";
-    std::cout << "Wind: " << grid.getWindSpeed() << " m/s at " 
+void FireSimulation::printStatus(std::ostream& out) const {
+    out << "=== Wildfire Simulation Status ===\n";
+    out << "Time: " << total_time << "s\n";
+    out << "Cells burning: " << cells_burning << "\n";
+    out << "Cells burned: " << cells_burned << "\n";
+    out << "Burn percentage: " << getBurnPercentage() << "%\n";
+    out << "Wind: " << grid.getWindSpeed() << " m/s at " 
               << grid.getWindDirection() << "°\n";
-    std::cout << "Temperature: " << grid.getAmbientTemp() << "°C\n";
-    std::cout << "Humidity: " << grid.getHumidity() * 100 << "%\n";
-    std::cout << "\nLegend: . = grass, o = shrub, T = tree, * = fire, x = burned\n";
-    std::cout << "        ~ = water/suppression, # = rock/firebreak, R = retardant\n";
-    std::cout << "        G = ground crew, W = water tanker, A = air tanker, H = helicopter\n\n";
+    out << "Temperature: " << grid.getAmbientTemp() << "°C\n";
+    out << "Humidity: " << grid.getHumidity() * 100 << "%\n";
+    out << "\nLegend: . = grass, o = shrub, T = tree, * = fire, x = burned\n";
+    out << "        ~ = water/suppression, # = rock/firebreak, R = retardant\n";
+    out << "        G = ground crew, W = water tanker, A = air tanker, H = helicopter\n\n";
 }
 
-void FireSimulation::saveToFile(const std::string& filename) const {
+bool FireSimulation::saveToFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << "Time," << total_time << "\n";
@@ -182,5 +236,32 @@ void FireSimulation::saveToFile(const std::string& filename) const {
             file << "\n";
         }
         file.close();
+        return !file.fail();
+    }
+    return false;
+}
+bool FireSimulation::saveSnapshot(const std::string& path, std::string& error) const {
+    return SnapshotIO::save(*this, path, error);
+}
+
+bool FireSimulation::loadSnapshot(const std::string& path, std::string& error) {
+    return SnapshotIO::load(*this, path, error);
+}
+
+bool FireSimulation::startRecording(const std::string& path, int every_steps, int keyframe_every,
+                                    std::string& error) {
+    if (!stopRecording(error)) {
+        return false;
     }
-}
\ No newline at end of file
+    std::unique_ptr<FrameRecorder> next(new FrameRecorder());
+    if (!next->open(path, grid.getWidth(), grid.getHeight(), every_steps, keyframe_every, error)) {
+        return false;
+    }
+    recorder = std::move(next);
+    recorder->capture(grid, human_manager, total_time);
+    return true;
+}
+
+bool FireSimulation::stopRecording(std::string& error) {
+    return !recorder || recorder->close(error);
+}
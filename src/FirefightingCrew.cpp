@@ -1,4 +1,6 @@
 #include "FirefightingCrew.h"
+#include "Grid.h"
+#include "SuppressionQueue.h"
 #include <iostream>
 #include <sstream>
 #include <cmath>
@@ -7,7 +9,7 @@
 FirefightingCrew::FirefightingCrew(int crew_id, const std::string& crew_name, 
                                    CrewType crew_type, int start_x, int start_y)
     : id(crew_id), name(crew_name), type(crew_type), x(start_x), y(start_y),
-      fatigue(0.0), available(true) {
+      fatigue(0.0), available(true), manager(nullptr) {
     
     switch (type) {
         case CrewType::GROUND_CREW:
@@ -43,10 +45,16 @@ FirefightingCrew::FirefightingCrew(int crew_id, const std::string& crew_name,
 void FirefightingCrew::moveTo(int target_x, int target_y) {
     if (!available) return;
     
+    int old_x = x;
+    int old_y = y;
     x = target_x;
     y = target_y;
     fatigue += 0.05; // Movement causes fatigue
     fatigue = std::min(fatigue, 1.0);
+    
+    if (manager) {
+        manager->onCrewMoved(*this, old_x, old_y);
+    }
 }
 
 SuppressionAction FirefightingCrew::deployWater(int target_x, int target_y, int radius) {
@@ -54,6 +62,8 @@ SuppressionAction FirefightingCrew::deployWater(int target_x, int target_y, int
     action.type = SuppressionType::WATER;
     action.x = target_x;
     action.y = target_y;
+    action.end_x = target_x;
+    action.end_y = target_y;
     action.radius = radius;
     action.effectiveness = getEffectiveness() * 0.8;
     action.duration = 300.0; // 5 minutes
@@ -72,6 +82,8 @@ SuppressionAction FirefightingCrew::deployRetardant(int target_x, int target_y,
     action.type = SuppressionType::RETARDANT;
     action.x = target_x;
     action.y = target_y;
+    action.end_x = target_x;
+    action.end_y = target_y;
     action.radius = radius;
     action.effectiveness = getEffectiveness() * 0.9;
     action.duration = 1800.0; // 30 minutes
@@ -90,6 +102,8 @@ SuppressionAction FirefightingCrew::createFirebreak(int start_x, int start_y, in
     action.type = SuppressionType::FIREBREAK;
     action.x = start_x;
     action.y = start_y;
+    action.end_x = end_x;
+    action.end_y = end_y;
     action.radius = abs(end_x - start_x) + abs(end_y - start_y);
     action.effectiveness = getEffectiveness() * 0.7;
     action.duration = -1.0; // Permanent
@@ -149,6 +163,16 @@ double FirefightingCrew::getResourceLevel(SuppressionType type) const {
     }
 }
 
+char FirefightingCrew::getDisplayChar() const {
+    switch (type) {
+        case CrewType::GROUND_CREW: return 'G';
+        case CrewType::WATER_TANKER: return 'W';
+        case CrewType::AIR_TANKER: return 'A';
+        case CrewType::HELICOPTER: return 'H';
+    }
+    return '?';
+}
+
 std::string FirefightingCrew::getStatusString() const {
     std::stringstream ss;
     ss << name << " (" << id << ") - ";
@@ -174,48 +198,147 @@ std::string FirefightingCrew::getStatusString() const {
 
 // HumanFactorManager implementation
 HumanFactorManager::HumanFactorManager(double initial_budget) 
-    : total_budget(initial_budget), spent_budget(0.0), next_crew_id(1) {
+    : total_budget(initial_budget), spent_budget(0.0), next_crew_id(1), suppression_queue(nullptr) {
+}
+
+HumanFactorManager::HumanFactorManager(const HumanFactorManager& other)
+    : crews(other.crews), evacuation_zones(other.evacuation_zones), total_budget(other.total_budget),
+      spent_budget(other.spent_budget), next_crew_id(other.next_crew_id), suppression_queue(nullptr) {
+    rebuildIndexes();
+}
+
+HumanFactorManager& HumanFactorManager::operator=(const HumanFactorManager& other) {
+    if (this != &other) {
+        crews = other.crews;
+        evacuation_zones = other.evacuation_zones;
+        total_budget = other.total_budget;
+        spent_budget = other.spent_budget;
+        next_crew_id = other.next_crew_id;
+        rebuildIndexes();
+        zone_danger.invalidate();
+    }
+    return *this;
+}
+
+void HumanFactorManager::rebuildIndexes() {
+    crew_slots.clear();
+    crew_positions.clear();
+    zone_areas.clear();
+    for (size_t slot = 0; slot < crews.size(); ++slot) {
+        FirefightingCrew& crew = crews[slot];
+        crew.manager = this;
+        crew_slots[crew.id] = static_cast<int>(slot);
+        crew_positions.insert(static_cast<int>(slot), crew.x, crew.y);
+    }
+    for (size_t i = 0; i < evacuation_zones.size(); ++i) {
+        const EvacuationZone& zone = evacuation_zones[i];
+        zone_areas.insert(static_cast<int>(i), zone.x - zone.radius, zone.y - zone.radius,
+                          zone.x + zone.radius, zone.y + zone.radius);
+    }
+}
+
+void HumanFactorManager::onCrewMoved(const FirefightingCrew& crew, int old_x, int old_y) {
+    // A copy of a crew still points here, but moving it must not move the
+    // crew it was copied from
+    auto slot = crew_slots.find(crew.id);
+    if (slot != crew_slots.end() && &crews[slot->second] == &crew) {
+        crew_positions.move(slot->second, old_x, old_y, crew.x, crew.y);
+    }
 }
 
 void HumanFactorManager::addCrew(const std::string& name, CrewType type, int x, int y) {
+    int slot = static_cast<int>(crews.size());
     crews.emplace_back(next_crew_id++, name, type, x, y);
+    crews.back().manager = this;
+    crew_slots[crews.back().id] = slot;
+    crew_positions.insert(slot, x, y);
 }
 
-void HumanFactorManager::deployCrewToLocation(int crew_id, int x, int y) {
-    for (auto& crew : crews) {
-        if (crew.getId() == crew_id && crew.isAvailable()) {
-            crew.moveTo(x, y);
-            break;
+FirefightingCrew* HumanFactorManager::findCrew(int crew_id) {
+    auto slot = crew_slots.find(crew_id);
+    return slot != crew_slots.end() ? &crews[slot->second] : nullptr;
+}
+
+const FirefightingCrew* HumanFactorManager::findCrew(int crew_id) const {
+    auto slot = crew_slots.find(crew_id);
+    return slot != crew_slots.end() ? &crews[slot->second] : nullptr;
+}
+
+void HumanFactorManager::findCrewsWithin(int x, int y, int radius, std::vector<int>& crew_ids) const {
+    crew_ids.clear();
+    if (radius < 0) return;
+    
+    std::vector<int> slots;
+    auto consider = [&](int slot) {
+        const FirefightingCrew& crew = crews[slot];
+        int64_t dx = crew.x - x;
+        int64_t dy = crew.y - y;
+        if (dx * dx + dy * dy <= static_cast<int64_t>(radius) * radius) {
+            slots.push_back(slot);
         }
+    };
+    
+    // A circle covering most of the map is cheaper to answer from the fleet list
+    if (SpatialHash::bucketSpan(x - radius, y - radius, x + radius, y + radius) >
+        static_cast<int64_t>(crews.size())) {
+        for (size_t slot = 0; slot < crews.size(); ++slot) consider(static_cast<int>(slot));
+    } else {
+        crew_positions.forEachInBox(x - radius, y - radius, x + radius, y + radius, consider);
+        std::sort(slots.begin(), slots.end());
+    }
+    for (int slot : slots) {
+        crew_ids.push_back(crews[slot].id);
+    }
+}
+
+void HumanFactorManager::findZonesCovering(int x, int y, std::vector<int>& zone_indices) const {
+    zone_indices.clear();
+    zone_areas.forEachInBox(x, y, x, y, [&](int i) {
+        const EvacuationZone& zone = evacuation_zones[i];
+        int64_t dx = x - zone.x;
+        int64_t dy = y - zone.y;
+        if (dx * dx + dy * dy <= static_cast<int64_t>(zone.radius) * zone.radius) {
+            zone_indices.push_back(i);
+        }
+    });
+    std::sort(zone_indices.begin(), zone_indices.end());
+}
+
+void HumanFactorManager::deployCrewToLocation(int crew_id, int x, int y) {
+    FirefightingCrew* crew = findCrew(crew_id);
+    if (crew && crew->isAvailable()) {
+        crew->moveTo(x, y);
     }
 }
 
 SuppressionAction HumanFactorManager::orderSuppression(int crew_id, SuppressionType type, 
                                                        int x, int y, int radius) {
-    for (auto& crew : crews) {
-        if (crew.getId() == crew_id && crew.canDeploy(type)) {
-            SuppressionAction action;
-            
-            switch (type) {
-                case SuppressionType::WATER:
-                    action = crew.deployWater(x, y, radius);
-                    break;
-                case SuppressionType::RETARDANT:
-                    action = crew.deployRetardant(x, y, radius);
-                    break;
-                case SuppressionType::FIREBREAK:
-                    action = crew.createFirebreak(x, y, x + radius, y);
-                    break;
-                default:
-                    action.effectiveness = 0.0;
-                    action.cost = 0.0;
-                    break;
-            }
-            
-            if (canAfford(action.cost)) {
-                spendBudget(action.cost);
-                return action;
+    FirefightingCrew* crew = findCrew(crew_id);
+    if (crew && crew->canDeploy(type)) {
+        SuppressionAction action;
+        
+        switch (type) {
+            case SuppressionType::WATER:
+                action = crew->deployWater(x, y, radius);
+                break;
+            case SuppressionType::RETARDANT:
+                action = crew->deployRetardant(x, y, radius);
+                break;
+            case SuppressionType::FIREBREAK:
+                action = crew->createFirebreak(x, y, x + radius, y);
+                break;
+            default:
+                action.effectiveness = 0.0;
+                action.cost = 0.0;
+                break;
+        }
+        
+        if (canAfford(action.cost)) {
+            spendBudget(action.cost);
+            if (suppression_queue) {
+                suppression_queue->push(action);
             }
+            return action;
         }
     }
     
@@ -243,6 +366,9 @@ void HumanFactorManager::addEvacuationZone(const std::string& name, int x, int y
     zone.evacuation_ordered = false;
     zone.danger_level = 0.0;
     evacuation_zones.push_back(zone);
+    zone_areas.insert(static_cast<int>(evacuation_zones.size()) - 1, x - radius, y - radius,
+                      x + radius, y + radius);
+    zone_danger.invalidate();
 }
 
 void HumanFactorManager::orderEvacuation(int zone_index) {
@@ -261,6 +387,10 @@ void HumanFactorManager::updateEvacuations(double dt) {
     }
 }
 
+void HumanFactorManager::updateDanger(const Grid& grid) {
+    zone_danger.update(grid, evacuation_zones);
+}
+
 bool HumanFactorManager::canAfford(double cost) const {
     return (spent_budget + cost) <= total_budget;
 }
@@ -269,37 +399,35 @@ void HumanFactorManager::spendBudget(double amount) {
     spent_budget += amount;
 }
 
-void HumanFactorManager::printStatus() const {
-    std::cout << "=== Human Factors Status ===\n";
-    std::cout << "Budget: $" << (int)getRemainingBudget() << " / $" << (int)total_budget << "\n\n";
+void HumanFactorManager::printStatus(std::ostream& out) const {
+    out << "=== Human Factors Status ===\n";
+    out << "Budget: $" << (int)getRemainingBudget() << " / $" << (int)total_budget << "\n\n";
     
-    std::cout << "Firefighting Crews (" << crews.size() << "):\n";
+    out << "Firefighting Crews (" << crews.size() << "):\n";
     for (const auto& crew : crews) {
-        std::cout << "  " << crew.getStatusString() << "\n";
+        out << "  " << crew.getStatusString() << "\n";
     }
     
     if (!evacuation_zones.empty()) {
-        std::cout << "\nEvacuation Zones (" << evacuation_zones.size() << "):\n";
+        out << "\nEvacuation Zones (" << evacuation_zones.size() << "):\n";
         for (const auto& zone : evacuation_zones) {
-            std::cout << "  " << zone.name << " [" << zone.x << "," << zone.y << "] ";
-            std::cout << "Pop: " << zone.evacuated << "/" << zone.population;
-            if (zone.evacuation_ordered) std::cout << " (EVACUATING)";
-            std::cout << "\n";
+            out << "  " << zone.name << " [" << zone.x << "," << zone.y << "] ";
+            out << "Pop: " << zone.evacuated << "/" << zone.population;
+            out << " Danger: " << (int)(zone.danger_level * 100) << "%";
+            if (zone.evacuation_ordered) out << " (EVACUATING)";
+            out << "\n";
         }
     }
-    std::cout << "\n";
+    out << "\n";
 }
 
 char HumanFactorManager::getCrewDisplayChar(int x, int y) const {
-    for (const auto& crew : crews) {
-        if (crew.getX() == x && crew.getY() == y) {
-            switch (crew.getType()) {
-                case CrewType::GROUND_CREW: return 'G';
-                case CrewType::WATER_TANKER: return 'W';
-                case CrewType::AIR_TANKER: return 'A';
-                case CrewType::HELICOPTER: return 'H';
-            }
+    // The first crew in fleet order shows when several share a cell
+    int first = -1;
+    crew_positions.forEachInBox(x, y, x, y, [&](int slot) {
+        if (crews[slot].x == x && crews[slot].y == y && (first < 0 || slot < first)) {
+            first = slot;
         }
-    }
-    return ' '; // No crew at this location
+    });
+    return first >= 0 ? crews[first].getDisplayChar() : ' '; // ' ' when no crew is here
 }
\ No newline at end of file
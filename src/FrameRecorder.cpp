@@ -0,0 +1,413 @@
+#include "FrameRecorder.h"
+#include "Grid.h"
+#include "FirefightingCrew.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const char kMagic[8] = {'W', 'F', 'F', 'R', 'A', 'M', 'E', '\n'};
+const uint8_t kKeyframe = 0;
+const uint8_t kDeltaFrame = 1;
+const size_t kHeaderBytes = 8 + 5 * sizeof(uint32_t);
+const size_t kFrameHeaderBytes = 1 + sizeof(uint32_t) + sizeof(double) + sizeof(uint32_t);
+// The queue holds at most this many bytes of cell codes, and at least four frames
+const size_t kMaxQueuedBytes = 64 << 20;
+const size_t kMinQueuedFrames = 4;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const std::vector<uint8_t>& in, size_t& position, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && position < in.size(); shift += 7) {
+        uint8_t byte = in[position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Eight cells at a time: 0x01 in every byte of value that is non-zero
+uint64_t nonZeroBytes(uint64_t value) {
+    const uint64_t kLow7 = 0x7F7F7F7F7F7F7F7FULL;
+    return ((((value & kLow7) + kLow7) | value) >> 7) & 0x0101010101010101ULL;
+}
+
+uint64_t loadWord(const uint8_t* bytes) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+// Length of the run of bytes equal to value starting at begin, comparing a
+// word at a time
+size_t runLength(const uint8_t* begin, size_t limit, uint8_t value) {
+    uint64_t pattern = 0x0101010101010101ULL * value;
+    size_t run = 0;
+    while (run + 8 <= limit && loadWord(begin + run) == pattern) run += 8;
+    while (run < limit && begin[run] == value) ++run;
+    return run;
+}
+
+template <typename T>
+void putRaw(char* out, size_t& position, T value) {
+    std::memcpy(out + position, &value, sizeof(value));
+    position += sizeof(value);
+}
+
+template <typename T>
+T getRaw(const char* in, size_t& position) {
+    T value;
+    std::memcpy(&value, in + position, sizeof(value));
+    position += sizeof(value);
+    return value;
+}
+}
+
+FrameRecorder::FrameRecorder()
+    : width(0), height(0), record_interval(1), keyframe_interval(1), max_queued(4), steps_seen(0),
+      stopping(false), frames_written(0), frames_dropped(0), frames_stalled(0) {}
+
+FrameRecorder::~FrameRecorder() {
+    std::string error;
+    close(error);
+}
+
+bool FrameRecorder::open(const std::string& path, int grid_width, int grid_height, int every_steps,
+                         int keyframe_every, std::string& error) {
+    if (isOpen()) {
+        error = "a recording is already open";
+        return false;
+    }
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+
+    width = grid_width;
+    height = grid_height;
+    max_queued = std::max(kMinQueuedFrames, kMaxQueuedBytes / (static_cast<size_t>(width) * height));
+    record_interval = every_steps > 0 ? every_steps : 1;
+    keyframe_interval = keyframe_every > 0 ? keyframe_every : 1;
+    steps_seen = 0;
+    stopping = false;
+    frames_written = 0;
+    frames_dropped = 0;
+    frames_stalled = 0;
+    write_error.clear();
+    previous.clear();
+
+    char header[kHeaderBytes];
+    size_t position = 0;
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    position += sizeof(kMagic);
+    putRaw(header, position, kFrameStreamVersion);
+    putRaw(header, position, static_cast<int32_t>(width));
+    putRaw(header, position, static_cast<int32_t>(height));
+    putRaw(header, position, static_cast<uint32_t>(keyframe_interval));
+    putRaw(header, position, static_cast<uint32_t>(record_interval));
+    file.write(header, sizeof(header));
+
+    writer = std::thread(&FrameRecorder::writerLoop, this);
+    return true;
+}
+
+bool FrameRecorder::close(std::string& error) {
+    if (!isOpen()) return true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frame_ready.notify_one();
+    writer.join();
+
+    file.close();
+    if (file.fail() && write_error.empty()) {
+        write_error = "error closing the frame stream";
+    }
+    queue.clear();
+    free_buffers.clear();
+    if (!write_error.empty()) {
+        error = write_error;
+        return false;
+    }
+    return true;
+}
+
+void FrameRecorder::onStep(const Grid& grid, const HumanFactorManager& human, double time) {
+    if (++steps_seen % record_interval == 0) {
+        capture(grid, human, time);
+    }
+}
+
+void FrameRecorder::capture(const Grid& grid, const HumanFactorManager& human, double time) {
+    if (!isOpen()) return;
+
+    std::vector<uint8_t> codes;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (grid.width != width || grid.height != height) {
+            ++frames_dropped;
+            return;
+        }
+        // Back-pressure: a replay needs every due step, so wait for the writer
+        if (queue.size() >= max_queued) {
+            ++frames_stalled;
+            frame_taken.wait(lock, [&] { return queue.size() < max_queued; });
+        }
+        if (!free_buffers.empty()) {
+            codes.swap(free_buffers.back());
+            free_buffers.pop_back();
+        }
+    }
+
+    // The only per-frame work on the stepping thread: one pass over four
+    // arrays, eight cells per word
+    codes.resize(static_cast<size_t>(width) * height);
+    uint8_t* out = codes.data();
+    for (int y = 0; y < height; ++y) {
+        int begin = grid.index(0, y);
+        int x = 0;
+        for (; x + 8 <= width; x += 8, out += 8) {
+            int idx = begin + x;
+            uint64_t word = loadWord(&grid.states[idx]) |
+                            nonZeroBytes(loadWord(&grid.water_levels[idx])) << 2 |
+                            nonZeroBytes(loadWord(&grid.retardant_levels[idx])) << 3 |
+                            nonZeroBytes(loadWord(&grid.firebreaks[idx])) << 4;
+            std::memcpy(out, &word, sizeof(word));
+        }
+        for (; x < width; ++x) {
+            int idx = begin + x;
+            *out++ = static_cast<uint8_t>(grid.states[idx] |
+                                          (grid.water_levels[idx] ? kFrameWater : 0) |
+                                          (grid.retardant_levels[idx] ? kFrameRetardant : 0) |
+                                          (grid.firebreaks[idx] ? kFrameFirebreak : 0));
+        }
+    }
+    for (const FirefightingCrew& crew : human.getCrews()) {
+        if (grid.isValidPosition(crew.getX(), crew.getY())) {
+            codes[static_cast<size_t>(crew.getY()) * width + crew.getX()] |= kFrameCrew;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(PendingFrame{std::move(codes), grid.getStepCount(), time});
+    }
+    frame_ready.notify_one();
+}
+
+void FrameRecorder::writerLoop() {
+    long written = 0;
+    while (true) {
+        PendingFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frame_ready.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;  // Stopping and drained
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        frame_taken.notify_one();
+
+        writeFrame(frame, previous.empty() || written % keyframe_interval == 0);
+        ++written;
+        previous.swap(frame.codes);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        frames_written = written;
+        if (!file && write_error.empty()) {
+            write_error = "error writing the frame stream";
+        }
+        if (!frame.codes.empty()) {
+            free_buffers.push_back(std::move(frame.codes));
+        }
+    }
+}
+
+void FrameRecorder::writeFrame(const PendingFrame& frame, bool keyframe) {
+    const std::vector<uint8_t>& codes = frame.codes;
+    size_t count = codes.size();
+    payload.clear();
+
+    if (keyframe) {
+        for (size_t i = 0; i < count;) {
+            size_t run = runLength(&codes[i], count - i, codes[i]);
+            putVarint(payload, run);
+            payload.push_back(codes[i]);
+            i += run;
+        }
+    } else {
+        size_t last = 0;    // First cell not yet covered by the payload
+        for (size_t i = 0; i < count;) {
+            // Unchanged stretches are skipped a word at a time
+            if (i + 8 <= count && loadWord(&codes[i]) == loadWord(&previous[i])) {
+                i += 8;
+                continue;
+            }
+            if (codes[i] == previous[i]) {
+                ++i;
+                continue;
+            }
+            size_t run = 1;
+            while (i + run < count && codes[i + run] == codes[i] && codes[i + run] != previous[i + run]) ++run;
+            putVarint(payload, i - last);
+            putVarint(payload, run);
+            payload.push_back(codes[i]);
+            i += run;
+            last = i;
+        }
+    }
+
+    char header[kFrameHeaderBytes];
+    size_t position = 0;
+    putRaw(header, position, keyframe ? kKeyframe : kDeltaFrame);
+    putRaw(header, position, frame.step);
+    putRaw(header, position, frame.time);
+    putRaw(header, position, static_cast<uint32_t>(payload.size()));
+    file.write(header, sizeof(header));
+    file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+}
+
+long FrameRecorder::getFramesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames_written;
+}
+
+long FrameRecorder::getFramesDropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames_dropped;
+}
+
+long FrameRecorder::getFramesStalled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames_stalled;
+}
+
+FrameReader::FrameReader()
+    : width(0), height(0), record_interval(1), keyframe_interval(1), current_frame(-1) {}
+
+bool FrameReader::open(const std::string& path, std::string& error) {
+    file.close();
+    file.clear();
+    frames.clear();
+    current_frame = -1;
+
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    char header[kHeaderBytes];
+    if (!file.read(header, sizeof(header)) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a frame stream";
+        return false;
+    }
+    size_t position = sizeof(kMagic);
+    uint32_t version = getRaw<uint32_t>(header, position);
+    width = getRaw<int32_t>(header, position);
+    height = getRaw<int32_t>(header, position);
+    keyframe_interval = static_cast<int>(getRaw<uint32_t>(header, position));
+    record_interval = static_cast<int>(getRaw<uint32_t>(header, position));
+    if (version != kFrameStreamVersion) {
+        error = path + " has frame stream version " + std::to_string(version) +
+                ", expected " + std::to_string(kFrameStreamVersion);
+        return false;
+    }
+    if (width <= 0 || height <= 0) {
+        error = path + " has an invalid grid size";
+        return false;
+    }
+
+    // Index the frame headers, skipping over the payloads
+    file.seekg(0, std::ios::end);
+    uint64_t file_bytes = static_cast<uint64_t>(file.tellg());
+    uint64_t offset = kHeaderBytes;
+    while (offset + kFrameHeaderBytes <= file_bytes) {
+        char frame_header[kFrameHeaderBytes];
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (!file.read(frame_header, sizeof(frame_header))) break;
+
+        position = 0;
+        FrameEntry entry;
+        uint8_t type = getRaw<uint8_t>(frame_header, position);
+        entry.step = getRaw<uint32_t>(frame_header, position);
+        entry.time = getRaw<double>(frame_header, position);
+        entry.payload_bytes = getRaw<uint32_t>(frame_header, position);
+        entry.payload_offset = offset + kFrameHeaderBytes;
+        entry.keyframe = type == kKeyframe;
+        if ((type != kKeyframe && type != kDeltaFrame) ||
+            (frames.empty() && !entry.keyframe) ||
+            entry.payload_offset + entry.payload_bytes > file_bytes) {
+            break;
+        }
+        frames.push_back(entry);
+        offset = entry.payload_offset + entry.payload_bytes;
+    }
+    file.clear();
+    return true;
+}
+
+bool FrameReader::applyFrame(const FrameEntry& entry, std::string& error) {
+    payload.resize(entry.payload_bytes);
+    file.seekg(static_cast<std::streamoff>(entry.payload_offset));
+    if (!file.read(reinterpret_cast<char*>(payload.data()), entry.payload_bytes)) {
+        file.clear();
+        error = "cannot read frame payload";
+        return false;
+    }
+
+    size_t count = current.size();
+    size_t cell = 0;
+    size_t position = 0;
+    while (position < payload.size()) {
+        uint64_t skip = 0, run;
+        if ((!entry.keyframe && !getVarint(payload, position, skip)) ||
+            !getVarint(payload, position, run) || position >= payload.size() ||
+            skip > count - cell || run > count - cell - skip) {
+            error = "corrupt frame payload";
+            return false;
+        }
+        cell += skip;
+        std::memset(current.data() + cell, payload[position++], run);
+        cell += run;
+    }
+    if (entry.keyframe && cell != count) {
+        error = "keyframe does not cover the grid";
+        return false;
+    }
+    return true;
+}
+
+bool FrameReader::seek(int frame, std::vector<uint8_t>& codes, std::string& error) {
+    if (frame < 0 || frame >= getFrameCount()) {
+        error = "frame " + std::to_string(frame) + " is out of range";
+        return false;
+    }
+
+    int keyframe = frame;
+    while (!frames[keyframe].keyframe) --keyframe;
+
+    // Continue from the last decoded frame when no keyframe lies in between
+    int first = keyframe;
+    if (current_frame >= keyframe && current_frame <= frame) {
+        first = current_frame + 1;
+    } else {
+        current.assign(static_cast<size_t>(width) * height, 0);
+    }
+    for (int f = first; f <= frame; ++f) {
+        if (!applyFrame(frames[f], error)) {
+            current_frame = -1;
+            return false;
+        }
+        current_frame = f;
+    }
+    codes = current;
+    return true;
+}
@@ -0,0 +1,148 @@
+#include "FuelLayer.h"
+#include "Grid.h"
+#include <cstdlib>
+#include <vector>
+
+FuelLayer::FuelLayer() : FuelLayer(Kind::UNIFORM, 0, 0) {
+}
+
+FuelLayer::FuelLayer(Kind kind, int w, int h) : kind(kind), width(w), height(h) {
+}
+
+FuelLayer FuelLayer::uniform(int w, int h, const Cell& cell) {
+    FuelLayer layer(Kind::UNIFORM, w, h);
+    layer.uniform_cell = cell;
+    return layer;
+}
+
+FuelLayer FuelLayer::random(int w, int h, uint64_t seed) {
+    FuelLayer layer(Kind::RANDOM, w, h);
+    layer.rng.setSeed(seed);
+    return layer;
+}
+
+FuelLayer FuelLayer::terrain(int w, int h) {
+    return FuelLayer(Kind::TERRAIN, w, h);
+}
+
+FuelLayer FuelLayer::procedural(int w, int h, uint64_t seed, int feature_size) {
+    FuelLayer layer(Kind::PROCEDURAL, w, h);
+    layer.noise = ProceduralTerrain(seed, feature_size);
+    return layer;
+}
+
+FuelLayer FuelLayer::capture(const Grid& grid) {
+    FuelLayer layer(Kind::RASTER, grid.getWidth(), grid.getHeight());
+    size_t cells = static_cast<size_t>(layer.width) * layer.height;
+    layer.fuel_types.resize(cells);
+    layer.fuel_densities.resize(cells);
+    layer.moistures.resize(cells);
+    for (int y = 0; y < layer.height; ++y) {
+        int from = grid.index(0, y);
+        size_t to = static_cast<size_t>(y) * layer.width;
+        std::copy(grid.fuel_types.begin() + from, grid.fuel_types.begin() + from + layer.width,
+                  layer.fuel_types.begin() + to);
+        std::copy(grid.fuel_densities.begin() + from, grid.fuel_densities.begin() + from + layer.width,
+                  layer.fuel_densities.begin() + to);
+        std::copy(grid.moistures.begin() + from, grid.moistures.begin() + from + layer.width,
+                  layer.moistures.begin() + to);
+    }
+    return layer;
+}
+
+Cell FuelLayer::randomCell(const CounterRng& rng, uint64_t cell) {
+    // Five draws per cell, keyed by the cell so the terrain only depends on the seed
+    double draws[5];
+    rng.uniforms(0, cell, CounterRng::TERRAIN, 5, draws);
+
+    FuelType type;
+
+    // Add some water and rock obstacles
+    if (draws[0] < 0.05) {
+        type = FuelType::WATER;
+    } else if (draws[1] < 0.08) {
+        type = FuelType::ROCK;
+    } else {
+        switch (static_cast<int>(draws[2] * 3)) {
+            case 0: type = FuelType::GRASS; break;
+            case 1: type = FuelType::SHRUB; break;
+            case 2: type = FuelType::TREE; break;
+            default: type = FuelType::GRASS; break;
+        }
+    }
+
+    double density = 0.3 + draws[3] * 0.7;
+    double moisture = 0.1 + draws[4] * 0.5;
+    return Cell(type, density, moisture);
+}
+
+Cell FuelLayer::terrainCell(int x, int y, int width, int height) {
+    // Create a simple terrain with rivers and patches
+    FuelType type = FuelType::GRASS;
+    double density = 0.7;
+    double moisture = 0.3;
+
+    // Create a river diagonally
+    if (abs((x - y)) < 2) {
+        type = FuelType::WATER;
+    }
+    // Forest patch in upper right
+    else if (x > width/2 && y < height/2) {
+        type = FuelType::TREE;
+        density = 0.9;
+        moisture = 0.2;
+    }
+    // Shrub area in lower left
+    else if (x < width/3 && y > 2*height/3) {
+        type = FuelType::SHRUB;
+        density = 0.8;
+        moisture = 0.4;
+    }
+
+    return Cell(type, density, moisture);
+}
+
+Cell FuelLayer::getCell(int x, int y) const {
+    switch (kind) {
+        case Kind::RANDOM:
+            // Same key as Grid::initializeRandom
+            return randomCell(rng, static_cast<uint64_t>(y) * static_cast<uint64_t>(width) +
+                                   static_cast<uint64_t>(x));
+        case Kind::TERRAIN:
+            return terrainCell(x, y, width, height);
+        case Kind::PROCEDURAL:
+            return noise.cellAt(x, y);
+        case Kind::RASTER: {
+            size_t i = static_cast<size_t>(y) * width + x;
+            return Cell(static_cast<FuelType>(fuel_types[i]), fuel_densities[i] / 255.0, moistures[i] / 255.0);
+        }
+        default:
+            return uniform_cell;
+    }
+}
+
+void FuelLayer::fill(Grid& grid, int x0, int y0) const {
+    if (kind == Kind::PROCEDURAL) {
+        // A block at a time, so lattice values are not recomputed per cell
+        int w = grid.getWidth();
+        int h = grid.getHeight();
+        std::vector<uint8_t> types(static_cast<size_t>(w) * h), densities(types.size()), moisture(types.size());
+        noise.generate(x0, y0, w, h, types.data(), densities.data(), moisture.data(), w);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                size_t i = static_cast<size_t>(y) * w + x;
+                grid.setCell(x, y, Cell(static_cast<FuelType>(types[i]), densities[i] / 255.0, moisture[i] / 255.0));
+            }
+        }
+        return;
+    }
+    for (int y = 0; y < grid.getHeight(); ++y) {
+        for (int x = 0; x < grid.getWidth(); ++x) {
+            grid.setCell(x, y, getCell(x0 + x, y0 + y));
+        }
+    }
+}
+
+size_t FuelLayer::getBytes() const {
+    return sizeof(*this) + fuel_types.size() + fuel_densities.size() + moistures.size();
+}
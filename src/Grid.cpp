@@ -1,20 +1,213 @@
 #include "Grid.h"
 #include "FirefightingCrew.h"
+#include "ThreadPool.h"
+#include "BurnKernel.h"
+#include "FuelLayer.h"
 #include <iostream>
 #include <random>
 #include <cmath>
+#include <algorithm>
 
-Grid::Grid(int w, int h) : width(w), height(h), wind_speed(5.0), 
-                           wind_direction(90.0), ambient_temp(25.0), humidity(0.4) {
-    cells.resize(height);
-    suppression_effects.resize(height);
+namespace {
+// Density, moisture and suppression levels are stored as 8-bit fractions
+uint8_t encodeUnit(double value) {
+    return static_cast<uint8_t>(std::lround(std::min(1.0, std::max(0.0, value)) * 255.0));
+}
+
+double decodeUnit(uint8_t value) {
+    return value / 255.0;
+}
+
+// Calls fn(row_y, dx_begin, dx_end, factors) for each row of a drop's
+// footprint clipped to a width x height grid; factors is indexed by dx
+template <typename RowFn>
+void forEachFalloffRow(const FalloffKernel& kernel, int x, int y, int width, int height, RowFn&& fn) {
+    int radius = kernel.getRadius();
+    int dy_end = std::min(radius, height - 1 - y);
+    for (int dy = std::max(-radius, -y); dy <= dy_end; ++dy) {
+        int half = kernel.halfWidth(dy);
+        fn(y + dy, std::max(-half, -x), std::min(half, width - 1 - x), kernel.row(dy));
+    }
+}
+
+// Temperatures are stored in tenths of a degree
+int16_t encodeTemperature(double temp) {
+    return static_cast<int16_t>(std::lround(std::min(3276.7, std::max(-3276.8, temp)) * 10.0));
+}
+
+double decodeTemperature(int16_t temp) {
+    return temp / 10.0;
+}
+
+// Cached ignition probabilities are 16-bit fractions
+uint16_t encodeProbability(double prob) {
+    return static_cast<uint16_t>(std::lround(std::min(1.0, std::max(0.0, prob)) * 65535.0));
+}
+
+double decodeProbability(uint16_t prob) {
+    return prob / 65535.0;
+}
+}
+
+Grid::Grid(int w, int h) : width(w), height(h), stride(w + 2 * kHalo), wind_speed(5.0), 
+                           wind_direction(90.0), ambient_temp(25.0), humidity(0.4),
+                           spread_stencil(SpreadStencil::MOORE_8),
+                           update_mode(UpdateMode::ACTIVE_FRONT), clock(0.0), cell_lists_dirty(false),
+                           bitplane_check_pending(false), burning_list_stale(false), had_suppressed(false),
+                           change_log_enabled(false),
+                           burning_count(0), burned_count(0), fuel_count(0),
+                           step_count(0), origin_x(0), origin_y(0), landscape_width(w),
+                           thread_pool(nullptr) {
+    // Unseeded grids still vary from run to run; setSeed makes them reproducible
+    std::random_device rd;
+    rng.setSeed((static_cast<uint64_t>(rd()) << 32) | rd());
+    
+    // Ghost cells are zero-filled: EMPTY, so they never burn or spread
+    size_t cell_count = static_cast<size_t>(stride) * (height + 2 * kHalo);
+    states.resize(cell_count);
+    fuel_types.resize(cell_count);
+    fuel_densities.resize(cell_count);
+    moistures.resize(cell_count);
+    temperatures.resize(cell_count);
+    burn_times.resize(cell_count);
+    ignition_probabilities.resize(cell_count);
+    water_levels.assign(cell_count, 0);
+    retardant_levels.assign(cell_count, 0);
+    suppression_ends.clear();
+    firebreaks.assign(cell_count, 0);
+    ignite_bits.assign((cell_count + 63) / 64, 0);
+    
+    Cell default_cell;
     for (int y = 0; y < height; ++y) {
-        cells[y].resize(width);
-        suppression_effects[y].resize(width);
         for (int x = 0; x < width; ++x) {
-            suppression_effects[y][x] = {0.0, 0.0, 0.0, false};
+            storeCell(index(x, y), default_cell);
         }
     }
+    
+    rebuildSpreadKernel();
+}
+
+Cell Grid::loadCell(int idx) const {
+    Cell cell(static_cast<FuelType>(fuel_types[idx]), decodeUnit(fuel_densities[idx]),
+              decodeUnit(moistures[idx]));
+    cell.setState(static_cast<CellState>(states[idx]));
+    cell.setFuelDensity(decodeUnit(fuel_densities[idx]));
+    cell.setTemperature(decodeTemperature(temperatures[idx]));
+    cell.setBurnTime(burn_times[idx]);
+    return cell;
+}
+
+void Grid::storeCell(int idx, const Cell& cell) {
+    uint8_t fuel = static_cast<uint8_t>(cell.getFuelType());
+    uint8_t density = encodeUnit(cell.getFuelDensity());
+    uint8_t moisture = encodeUnit(cell.getMoisture());
+    int16_t temperature = encodeTemperature(cell.getTemperature());
+    
+    // The ignition cache only matters while a cell is unburned fuel, so it is
+    // refreshed when such a cell's inputs change or a cell turns back into fuel
+    bool refresh = cell.getState() == CellState::FUEL &&
+                   (static_cast<CellState>(states[idx]) != CellState::FUEL ||
+                    fuel_types[idx] != fuel || fuel_densities[idx] != density ||
+                    moistures[idx] != moisture || temperatures[idx] != temperature);
+    
+    invalidateBitplane();
+    if (change_log_enabled && static_cast<CellState>(states[idx]) != cell.getState()) {
+        CellState before = static_cast<CellState>(states[idx]);
+        if (before == CellState::BURNING || before == CellState::BURNED ||
+            cell.getState() == CellState::BURNING || cell.getState() == CellState::BURNED) {
+            changed_cells.push_back(idx);
+        }
+    }
+    countCell(idx, -1);
+    states[idx] = static_cast<uint8_t>(cell.getState());
+    fuel_types[idx] = fuel;
+    fuel_densities[idx] = density;
+    moistures[idx] = moisture;
+    temperatures[idx] = temperature;
+    burn_times[idx] = static_cast<float>(cell.getBurnTime());
+    countCell(idx, 1);
+    
+    if (refresh) {
+        refreshIgnitionProbability(idx);
+    }
+}
+
+void Grid::countCell(int idx, int delta) {
+    CellState state = static_cast<CellState>(states[idx]);
+    if (state == CellState::BURNING) {
+        burning_count += delta;
+    } else if (state == CellState::BURNED) {
+        burned_count += delta;
+    }
+    if (state == CellState::BURNING || state == CellState::BURNED || canBurnAt(idx)) {
+        fuel_count += delta;
+    }
+}
+
+void Grid::countCells(int& burning, int& burned, int& fuel) const {
+    burning = 0;
+    burned = 0;
+    fuel = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int idx = index(0, y); idx < index(width, y); ++idx) {
+            CellState state = static_cast<CellState>(states[idx]);
+            if (state == CellState::BURNING) {
+                burning++;
+            } else if (state == CellState::BURNED) {
+                burned++;
+            }
+            if (state == CellState::BURNING || state == CellState::BURNED || canBurnAt(idx)) {
+                fuel++;
+            }
+        }
+    }
+}
+
+void Grid::refreshIgnitionProbability(int idx) {
+    Cell cell = loadCell(idx);
+    cell.setState(CellState::FUEL);
+    ignition_probabilities[idx] = encodeProbability(cell.getIgnitionProbability());
+}
+
+double Grid::ignitionProbabilityAt(int idx) const {
+    return canBurnAt(idx) ? decodeProbability(ignition_probabilities[idx]) : 0.0;
+}
+
+void Grid::setCell(int x, int y, const Cell& cell) {
+    int idx = index(x, y);
+    storeCell(idx, cell);
+    if (cell.getState() == CellState::BURNING) {
+        burning_cells.push_back(idx);
+        cell_lists_dirty = true;
+    }
+}
+
+bool Grid::canBurnAt(int idx) const {
+    FuelType type = static_cast<FuelType>(fuel_types[idx]);
+    return static_cast<CellState>(states[idx]) == CellState::FUEL &&
+           type != FuelType::WATER && type != FuelType::ROCK &&
+           decodeUnit(fuel_densities[idx]) > 0.1;
+}
+
+SuppressionEffect Grid::getSuppressionEffect(int x, int y) const {
+    int idx = index(x, y);
+    auto end = suppression_ends.find(idx);
+    double remaining = end == suppression_ends.end() ? 0.0 : std::max(0.0, end->second - clock);
+    return {decodeUnit(water_levels[idx]), decodeUnit(retardant_levels[idx]), remaining, firebreaks[idx] != 0};
+}
+
+char Grid::getDisplayChar(int x, int y) const {
+    int idx = index(x, y);
+    if (firebreaks[idx]) return '#';
+    if (decodeUnit(water_levels[idx]) > 0.5) return '~';
+    if (decodeUnit(retardant_levels[idx]) > 0.5) return 'R';
+    return Cell::getDisplayChar(static_cast<CellState>(states[idx]), static_cast<FuelType>(fuel_types[idx]));
+}
+
+size_t Grid::getBytesPerCell() const {
+    return sizeof(uint8_t) * 4 + sizeof(int16_t) + sizeof(float) +   // cell fields
+           sizeof(uint16_t) +                                         // ignition cache
+           sizeof(uint8_t) * 3;                                       // suppression fields
 }
 
 bool Grid::isValidPosition(int x, int y) const {
@@ -22,69 +215,65 @@ bool Grid::isValidPosition(int x, int y) const {
 }
 
 void Grid::initializeRandom() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> fuel_dist(0.3, 1.0);
-    std::uniform_real_distribution<> moisture_dist(0.1, 0.6);
-    std::uniform_int_distribution<> type_dist(0, 2);
-    std::uniform_real_distribution<> special_dist(0.0, 1.0);
-    
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
-            FuelType type;
-            
-            // Add some water and rock obstacles
-            if (special_dist(gen) < 0.05) {
-                type = FuelType::WATER;
-            } else if (special_dist(gen) < 0.08) {
-                type = FuelType::ROCK;
-            } else {
-                switch (type_dist(gen)) {
-                    case 0: type = FuelType::GRASS; break;
-                    case 1: type = FuelType::SHRUB; break;
-                    case 2: type = FuelType::TREE; break;
-                    default: type = FuelType::GRASS; break;
-                }
-            }
-            
-            cells[y][x] = Cell(type, fuel_dist(gen), moisture_dist(gen));
+            setCell(x, y, FuelLayer::randomCell(rng, static_cast<uint64_t>(y) * width + x));
         }
     }
 }
 
 void Grid::initializeTerrain() {
-    // Create a simple terrain with rivers and patches
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
-            FuelType type = FuelType::GRASS;
-            double density = 0.7;
-            double moisture = 0.3;
-            
-            // Create a river diagonally
-            if (abs((x - y)) < 2) {
-                type = FuelType::WATER;
-            }
-            // Forest patch in upper right
-            else if (x > width/2 && y < height/2) {
-                type = FuelType::TREE;
-                density = 0.9;
-                moisture = 0.2;
-            }
-            // Shrub area in lower left
-            else if (x < width/3 && y > 2*height/3) {
-                type = FuelType::SHRUB;
-                density = 0.8;
-                moisture = 0.4;
+            setCell(x, y, FuelLayer::terrainCell(x, y, width, height));
+        }
+    }
+}
+
+void Grid::initializeProcedural(int feature_size) {
+    // Bands are generated in parallel straight into the cell arrays and come
+    // out as setCell would leave them, whatever the thread count. Like a
+    // snapshot load, this replaces cells wholesale and clears the change log.
+    ProceduralTerrain terrain(rng.getSeed(), feature_size);
+    const Cell pristine;
+    int16_t temperature = encodeTemperature(pristine.getTemperature());
+    float burn_time = static_cast<float>(pristine.getBurnTime());
+    
+    auto task = [&](int b) {
+        int y_begin = b * kBandRows;
+        int y_end = std::min(height, y_begin + kBandRows);
+        int first = index(0, y_begin);
+        terrain.generate(origin_x, origin_y + y_begin, width, y_end - y_begin,
+                         &fuel_types[first], &fuel_densities[first], &moistures[first], stride);
+        for (int y = y_begin; y < y_end; ++y) {
+            for (int idx = index(0, y); idx < index(width, y); ++idx) {
+                FuelType type = static_cast<FuelType>(fuel_types[idx]);
+                bool burnable = type != FuelType::WATER && type != FuelType::ROCK;
+                states[idx] = static_cast<uint8_t>(burnable ? CellState::FUEL : CellState::EMPTY);
+                temperatures[idx] = temperature;
+                burn_times[idx] = burn_time;
+                if (burnable) {
+                    refreshIgnitionProbability(idx);
+                }
             }
-            
-            cells[y][x] = Cell(type, density, moisture);
+        }
+    };
+    int band_count = (height + kBandRows - 1) / kBandRows;
+    if (thread_pool) {
+        thread_pool->parallelFor(band_count, task);
+    } else {
+        for (int b = 0; b < band_count; ++b) {
+            task(b);
         }
     }
+    rebuildDerivedState();
 }
 
 void Grid::igniteCell(int x, int y) {
     if (isValidPosition(x, y)) {
-        cells[y][x].ignite();
+        Cell cell = getCell(x, y);
+        cell.ignite();
+        setCell(x, y, cell);
     }
 }
 
@@ -96,7 +285,7 @@ void Grid::display() const {
     for (int y = 0; y < height; ++y) {
         std::cout << "|";
         for (int x = 0; x < width; ++x) {
-            std::cout << cells[y][x].getDisplayChar();
+            std::cout << getCell(x, y).getDisplayChar();
         }
         std::cout << "|\n";
     }
@@ -107,170 +296,695 @@ void Grid::display() const {
 }
 
 std::vector<std::pair<int, int>> Grid::getNeighbors(int x, int y) const {
+    // 8-directional neighbors; the update itself uses the stencils directly
     std::vector<std::pair<int, int>> neighbors;
+    neighbors.reserve(Moore8::kSize);
+    forEachNeighbor<Moore8>(x, y, [&](int nx, int ny) { neighbors.push_back({nx, ny}); });
+    return neighbors;
+}
+
+void Grid::setWindSpeed(double speed) {
+    wind_speed = speed;
+    rebuildSpreadKernel();
+}
+
+void Grid::setWindDirection(double direction) {
+    wind_direction = direction;
+    rebuildSpreadKernel();
+}
+
+double Grid::windDistanceFactor(int dx, int dy) const {
+    double factor = 1.0;
     
-    // 8-directional neighbors
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            if (dx == 0 && dy == 0) continue; // Skip center cell
-            
-            int nx = x + dx;
-            int ny = y + dy;
-            
-            if (isValidPosition(nx, ny)) {
-                neighbors.push_back({nx, ny});
-            }
-        }
+    // Wind effect
+    double spread_angle = atan2(dy, dx) * 180.0 / M_PI;
+    double wind_effect = cos((spread_angle - wind_direction) * M_PI / 180.0);
+    
+    // Wind increases probability in wind direction
+    if (wind_effect > 0) {
+        factor *= (1.0 + wind_speed * wind_effect * 0.1);
     }
     
-    return neighbors;
+    // Distance effect (diagonal neighbors are farther)
+    double distance = sqrt(dx*dx + dy*dy);
+    return factor / distance;
+}
+
+void Grid::rebuildSpreadKernel() {
+    // Wind only changes through the setters, so the trigonometry is done once per
+    // change instead of once per burning cell and neighbour
+    for (int dy = -kMaxStencilRadius; dy <= kMaxStencilRadius; ++dy) {
+        for (int dx = -kMaxStencilRadius; dx <= kMaxStencilRadius; ++dx) {
+            spread_kernel[(dy + 2) * 5 + (dx + 2)] = (dx == 0 && dy == 0) ? 0.0 : windDistanceFactor(dx, dy);
+        }
+    }
 }
 
 double Grid::calculateSpreadProbability(int from_x, int from_y, int to_x, int to_y) const {
-    const Cell& from_cell = cells[from_y][from_x];
-    const Cell& to_cell = cells[to_y][to_x];
+    int dx = to_x - from_x;
+    int dy = to_y - from_y;
+    
+    double kernel;
+    if (abs(dx) <= kMaxStencilRadius && abs(dy) <= kMaxStencilRadius) {
+        kernel = spread_kernel[(dy + 2) * 5 + (dx + 2)];
+    } else {
+        kernel = windDistanceFactor(dx, dy);
+    }
     
-    if (from_cell.getState() != CellState::BURNING || !to_cell.canBurn()) {
+    return spreadProbabilityAt(index(from_x, from_y), index(to_x, to_y), kernel);
+}
+
+double Grid::spreadProbabilityAt(int from_idx, int to_idx, double kernel) const {
+    if (static_cast<CellState>(states[from_idx]) != CellState::BURNING || !canBurnAt(to_idx)) {
         return 0.0;
     }
     
     // Check for firebreaks
-    const SuppressionEffect& to_suppression = suppression_effects[to_y][to_x];
-    if (to_suppression.is_firebreak) {
+    if (firebreaks[to_idx]) {
         return 0.0; // Firebreaks completely block spread
     }
     
-    double base_prob = to_cell.getIgnitionProbability() * 0.1; // Base spread rate
-    
-    // Wind effect
-    double dx = to_x - from_x;
-    double dy = to_y - from_y;
-    double spread_angle = atan2(dy, dx) * 180.0 / M_PI;
-    double wind_effect = cos((spread_angle - wind_direction) * M_PI / 180.0);
-    
-    // Wind increases probability in wind direction
-    if (wind_effect > 0) {
-        base_prob *= (1.0 + wind_speed * wind_effect * 0.1);
-    }
+    return spreadProbability(ignitionProbabilityAt(to_idx), kernel, temperatures[from_idx],
+                             suppressionModifierAt(to_idx));
+}
+
+double Grid::spreadProbability(double ignition, double kernel, int16_t source_temperature,
+                               double suppression) const {
+    double base_prob = ignition * 0.1; // Base spread rate
     
-    // Distance effect (diagonal neighbors are farther)
-    double distance = sqrt(dx*dx + dy*dy);
-    base_prob /= distance;
+    // Wind and distance effect
+    base_prob *= kernel;
     
     // Temperature effect from burning cell
-    double temp_effect = (from_cell.getTemperature() - ambient_temp) / 100.0;
-    base_prob *= (1.0 + temp_effect * 0.2);
+    base_prob *= sourceHeatFactor(source_temperature);
     
     // Apply suppression effects
-    double suppression_modifier = getSuppressionModifier(to_x, to_y);
-    base_prob *= (1.0 - suppression_modifier);
+    base_prob *= (1.0 - suppression);
     
     return std::min(1.0, std::max(0.0, base_prob));
 }
 
+double Grid::sourceHeatFactor(int16_t source_temperature) const {
+    double temp_effect = (decodeTemperature(source_temperature) - ambient_temp) / 100.0;
+    return 1.0 + temp_effect * 0.2;
+}
+
+template <typename Stencil, typename MarkFn>
+void Grid::spreadFrom(int from, double dt, MarkFn&& mark) const {
+    static_assert(Stencil::kRadius <= kHalo, "stencil reaches past the ghost border");
+    
+    // One draw per direction, generated for the whole stencil at once
+    double draws[Stencil::kSize];
+    rng.uniforms(step_count, logicalIndex(from), CounterRng::SPREAD, Stencil::kSize, draws);
+    
+    // Ghost cells cannot burn, so border cells need no bounds checks
+    for (int direction = 0; direction < Stencil::kSize; ++direction) {
+        const StencilOffset& offset = Stencil::kOffsets[direction];
+        int to = from + offset.dy * stride + offset.dx;
+        if (canBurnAt(to)) {
+            double prob = spreadProbabilityAt(from, to, spread_kernel[(offset.dy + 2) * 5 + (offset.dx + 2)]);
+            
+            // Use probability to determine ignition
+            if (draws[direction] < prob * dt) {
+                mark(to);
+            }
+        }
+    }
+}
+
+template <typename MarkFn>
+void Grid::spreadFromCell(int from, double dt, MarkFn&& mark) const {
+    switch (spread_stencil) {
+        case SpreadStencil::VON_NEUMANN_4: spreadFrom<VonNeumann4>(from, dt, mark); break;
+        case SpreadStencil::EXTENDED_16: spreadFrom<Extended16>(from, dt, mark); break;
+        case SpreadStencil::EXTENDED_24: spreadFrom<Extended24>(from, dt, mark); break;
+        default: spreadFrom<Moore8>(from, dt, mark); break;
+    }
+}
+
+template <typename Stencil>
+void Grid::spreadFromHalo(double dt) {
+    // Same draws and probabilities as spreadFrom in the grid that owns the
+    // source; only the directions that land on this grid are used
+    for (const HaloSource& source : halo_sources) {
+        double draws[Stencil::kSize];
+        rng.uniforms(step_count, logicalIndexAt(source.x, source.y), CounterRng::SPREAD, Stencil::kSize, draws);
+        
+        for (int direction = 0; direction < Stencil::kSize; ++direction) {
+            const StencilOffset& offset = Stencil::kOffsets[direction];
+            if (!isValidPosition(source.x + offset.dx, source.y + offset.dy)) continue;
+            int to = index(source.x + offset.dx, source.y + offset.dy);
+            if (!canBurnAt(to) || firebreaks[to]) continue;
+            
+            double prob = spreadProbability(ignitionProbabilityAt(to),
+                                            spread_kernel[(offset.dy + 2) * 5 + (offset.dx + 2)],
+                                            source.temperature, suppressionModifierAt(to));
+            if (draws[direction] < prob * dt) {
+                markIgnition(to);
+            }
+        }
+    }
+}
+
+void Grid::spreadFromHaloSources(double dt) {
+    if (halo_sources.empty()) return;
+    switch (spread_stencil) {
+        case SpreadStencil::VON_NEUMANN_4: spreadFromHalo<VonNeumann4>(dt); break;
+        case SpreadStencil::EXTENDED_16: spreadFromHalo<Extended16>(dt); break;
+        case SpreadStencil::EXTENDED_24: spreadFromHalo<Extended24>(dt); break;
+        default: spreadFromHalo<Moore8>(dt); break;
+    }
+}
+
+bool Grid::igniteAt(int idx) {
+    // Same as Cell::ignite
+    if (canBurnAt(idx)) {
+        states[idx] = static_cast<uint8_t>(CellState::BURNING);
+        burn_times[idx] = 0.0f;
+        temperatures[idx] = kIgnitionTemperature;
+        return true;
+    }
+    return false;
+}
+
+int Grid::advanceBurning(int begin, int end, double dt) {
+    BurnSpan span{&states[begin], &fuel_types[begin], &fuel_densities[begin], &moistures[begin],
+                  &temperatures[begin], &burn_times[begin], end - begin};
+    return burnProgress(span, static_cast<float>(dt));
+}
+
+int Grid::advanceBurning(const std::vector<int>& sorted_cells, int first, int last, double dt) {
+    // Nearby cells are covered by one kernel call; cells in the gaps are not
+    // burning, so the kernel leaves them alone
+    const int kMaxGap = 16;
+    int burnouts = 0;
+    int i = first;
+    while (i < last) {
+        int run_end = i + 1;
+        while (run_end < last && sorted_cells[run_end] - sorted_cells[run_end - 1] <= kMaxGap) {
+            ++run_end;
+        }
+        burnouts += advanceBurning(sorted_cells[i], sorted_cells[run_end - 1] + 1, dt);
+        i = run_end;
+    }
+    return burnouts;
+}
+
+void Grid::expireSuppression() {
+    // An entry is stale when a later drop pushed the cell's end further out;
+    // the later drop scheduled its own entry. The slack absorbs rounding in
+    // the summed clock, so a 1 s effect at dt 0.1 ends after ten steps.
+    double now = clock + kClockSlack;
+    suppression_expiries.advance(now, [&](int idx, double) {
+        auto end = suppression_ends.find(idx);
+        if (end != suppression_ends.end() && end->second <= now) {
+            suppression_ends.erase(end);
+            water_levels[idx] = 0;
+            retardant_levels[idx] = 0;
+        }
+    });
+}
+
+bool Grid::extinguishAt(int idx, double dt) {
+    // Water and retardant also extinguish existing fires
+    if (static_cast<CellState>(states[idx]) == CellState::BURNING) {
+        double suppression = suppressionModifierAt(idx);
+        if (suppression > 0.5) { // Strong suppression can extinguish fires
+            double draw = rng.uniform(step_count, logicalIndex(idx), CounterRng::EXTINGUISH);
+            if (draw < suppression * dt * 2.0) {
+                states[idx] = static_cast<uint8_t>(CellState::BURNED);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Grid::prepareBands(const std::vector<int>& sorted_cells) {
+    int band_count = (height + kBandRows - 1) / kBandRows;
+    if (static_cast<int>(bands.size()) != band_count) {
+        bands.resize(band_count);
+    }
+    
+    // Split an index-sorted cell list at band boundaries
+    auto it = sorted_cells.begin();
+    for (int b = 0; b < band_count; ++b) {
+        int band_end = index(0, std::min(height, (b + 1) * kBandRows));
+        auto next = std::lower_bound(it, sorted_cells.end(), band_end);
+        bands[b].first = static_cast<int>(it - sorted_cells.begin());
+        bands[b].last = static_cast<int>(next - sorted_cells.begin());
+        it = next;
+    }
+}
+
+template <typename Task>
+void Grid::forEachBand(const Task& task) {
+    int band_count = static_cast<int>(bands.size());
+    if (thread_pool) {
+        thread_pool->parallelFor(band_count, task);
+    } else {
+        for (int b = 0; b < band_count; ++b) {
+            task(b);
+        }
+    }
+}
+
+void Grid::rebuildDerivedState() {
+    // Everything not stored per cell follows from the cell arrays, the weather
+    // and the update mode; called after the arrays were replaced wholesale
+    size_t cell_count = static_cast<size_t>(stride) * (height + 2 * kHalo);
+    rebuildSpreadKernel();
+    ignite_bits.assign((cell_count + 63) / 64, 0);
+    ignite_list.clear();
+    bands.clear();
+    
+    bitplane.detach();
+    burning_list_stale = true;
+    bitplane_check_pending = update_mode == UpdateMode::BITPLANE;
+    suppression_expiries.reset(clock);
+    for (const auto& end : suppression_ends) {
+        suppression_expiries.schedule(end.second, end.first);
+    }
+    had_suppressed = !suppression_expiries.empty();
+    cell_lists_dirty = true;
+    changed_cells.clear();
+    countCells(burning_count, burned_count, fuel_count);
+}
+
+void Grid::resetTo(const Grid& initial) {
+    // Same size, so every assign reuses the storage
+    states = initial.states;
+    fuel_densities = initial.fuel_densities;
+    temperatures = initial.temperatures;
+    burn_times = initial.burn_times;
+    ignition_probabilities = initial.ignition_probabilities;
+    water_levels = initial.water_levels;
+    retardant_levels = initial.retardant_levels;
+    suppression_ends = initial.suppression_ends;
+    firebreaks = initial.firebreaks;
+    
+    wind_speed = initial.wind_speed;
+    wind_direction = initial.wind_direction;
+    ambient_temp = initial.ambient_temp;
+    humidity = initial.humidity;
+    spread_stencil = initial.spread_stencil;
+    update_mode = initial.update_mode;
+    clock = initial.clock;
+    rng = initial.rng;
+    step_count = initial.step_count;
+    origin_x = initial.origin_x;
+    origin_y = initial.origin_y;
+    landscape_width = initial.landscape_width;
+    halo_sources = initial.halo_sources;
+    rebuildDerivedState();
+}
+
+void Grid::setChangeLogEnabled(bool enabled) {
+    change_log_enabled = enabled;
+    changed_cells.clear();
+}
+
+void Grid::logChangedCells(const std::vector<int>& cells) {
+    if (change_log_enabled) {
+        changed_cells.insert(changed_cells.end(), cells.begin(), cells.end());
+    }
+}
+
+void Grid::setUpdateMode(UpdateMode mode) {
+    update_mode = mode;
+    invalidateBitplane();
+}
+
+void Grid::invalidateBitplane() {
+    if (bitplane.isAttached()) {
+        bitplane.detach();
+        burning_list_stale = true;
+    }
+    bitplane_check_pending = update_mode == UpdateMode::BITPLANE;
+}
+
 void Grid::update(double dt) {
-    // Create a copy to avoid updating cells as we read from neighbors
-    std::vector<std::vector<bool>> will_ignite(height, std::vector<bool>(width, false));
+    // Engines see the time at the end of the step; suppression ending by
+    // then is gone before fires are extinguished
+    clock += dt;
+    if (update_mode == UpdateMode::FULL_SCAN) {
+        updateFullScan(dt);
+    } else if (update_mode != UpdateMode::BITPLANE || !updateBitplane(dt)) {
+        updateActiveFront(dt);
+    }
+    ++step_count;
+}
+
+bool Grid::updateBitplane(double dt) {
+    // Attaching scans the whole grid, so it is only tried after something changed
+    if (!bitplane.isAttached()) {
+        if (!bitplane_check_pending) return false;
+        bitplane_check_pending = false;
+        if (!bitplane.attach(*this)) return false;
+    }
     
-    // First pass: determine which cells will ignite
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (cells[y][x].getState() == CellState::BURNING) {
-                auto neighbors = getNeighbors(x, y);
-                
-                for (auto& [nx, ny] : neighbors) {
-                    if (cells[ny][nx].canBurn()) {
-                        double prob = calculateSpreadProbability(x, y, nx, ny);
-                        
-                        // Use probability to determine ignition
-                        static std::random_device rd;
-                        static std::mt19937 gen(rd());
-                        std::uniform_real_distribution<> dist(0.0, 1.0);
-                        
-                        if (dist(gen) < prob * dt) {
-                            will_ignite[ny][nx] = true;
-                        }
-                    }
+    bitplane.update(*this, dt);
+    burning_list_stale = true;
+    return true;
+}
+
+void Grid::updateFullScan(double dt) {
+    if (change_log_enabled) {
+        // The log is taken from the burning list, which must be current
+        normalizeCellLists();
+    }
+    prepareBands(burning_cells);
+    
+    // First pass: each band of rows determines which cells its fires ignite.
+    // Targets are collected per band and merged afterwards, so cells on band
+    // borders are never written by two threads.
+    forEachBand([&](int b) {
+        Band& band = bands[b];
+        band.ignitions.clear();
+        int y_end = std::min(height, (b + 1) * kBandRows);
+        for (int y = b * kBandRows; y < y_end; ++y) {
+            for (int idx = index(0, y); idx < index(width, y); ++idx) {
+                if (static_cast<CellState>(states[idx]) == CellState::BURNING) {
+                    spreadFromCell(idx, dt, [&](int to) { band.ignitions.push_back(to); });
                 }
             }
         }
-    }
+    });
+    collectIgnitions();
+    spreadFromHaloSources(dt);
+    logChangedCells(burning_cells);
+    logChangedCells(ignite_list);
     
-    // Second pass: ignite cells and update all cells
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (will_ignite[y][x]) {
-                cells[y][x].ignite();
+    // Second pass: ignite cells, advance burning cells with the vector kernel,
+    // then let suppression put out burning cells. This sweeps every cell, so
+    // the full scan stays O(cells) per step; only suppression expiry comes
+    // off the wheel.
+    expireSuppression();
+    forEachBand([&](int b) {
+        Band& band = bands[b];
+        band.burning.clear();
+        band.ignited = 0;
+        band.burned_out = 0;
+        int y_begin = b * kBandRows;
+        int y_end = std::min(height, (b + 1) * kBandRows);
+        forEachPendingIgnition(index(0, y_begin), index(0, y_end), [&](int idx) {
+            if (igniteAt(idx)) {
+                band.ignited++;
             }
-            cells[y][x].update(dt);
-            
-            // Update suppression effects
-            SuppressionEffect& effect = suppression_effects[y][x];
-            if (effect.remaining_time > 0) {
-                effect.remaining_time -= dt;
-                if (effect.remaining_time <= 0) {
-                    effect.water_level = 0.0;
-                    effect.retardant_level = 0.0;
-                }
+        });
+        
+        band.burned_out += advanceBurning(index(0, y_begin), index(0, y_end), dt);
+        
+        for (int idx = index(0, y_begin); idx < index(0, y_end); ++idx) {
+            if (extinguishAt(idx, dt)) {
+                band.burned_out++;
             }
             
-            // Water and retardant also extinguish existing fires
-            if (cells[y][x].getState() == CellState::BURNING) {
-                double suppression = getSuppressionModifier(x, y);
-                if (suppression > 0.5) { // Strong suppression can extinguish fires
-                    static std::random_device rd;
-                    static std::mt19937 gen(rd());
-                    std::uniform_real_distribution<> dist(0.0, 1.0);
-                    
-                    if (dist(gen) < suppression * dt * 2.0) {
-                        cells[y][x].setState(CellState::BURNED);
-                    }
-                }
+            // Keep the active-front list valid so the modes can be switched at any step
+            if (static_cast<CellState>(states[idx]) == CellState::BURNING) {
+                band.burning.push_back(idx);
             }
         }
+    });
+    collectBandLists();
+    clearIgnitions();
+}
+
+void Grid::collectIgnitions() {
+    // Merged serially: a cell next to a band border can be targeted by two bands
+    for (const Band& band : bands) {
+        for (int to : band.ignitions) {
+            markIgnition(to);
+        }
     }
 }
 
-void Grid::applyWaterDrop(int x, int y, int radius, double effectiveness, double duration) {
-    for (int dy = -radius; dy <= radius; ++dy) {
-        for (int dx = -radius; dx <= radius; ++dx) {
-            int target_x = x + dx;
-            int target_y = y + dy;
-            
-            if (isValidPosition(target_x, target_y)) {
-                double distance = sqrt(dx*dx + dy*dy);
-                if (distance <= radius) {
-                    SuppressionEffect& effect = suppression_effects[target_y][target_x];
-                    double distance_factor = 1.0 - (distance / radius);
-                    
-                    effect.water_level = std::max(effect.water_level, 
-                                                effectiveness * distance_factor);
-                    effect.remaining_time = std::max(effect.remaining_time, duration);
+template <typename Fn>
+void Grid::forEachPendingIgnition(int begin, int end, Fn&& fn) const {
+    // Whole words of the mask at a time; only set bits are visited
+    int first_word = begin >> 6;
+    int last_word = (end - 1) >> 6;
+    for (int w = first_word; w <= last_word; ++w) {
+        uint64_t bits = ignite_bits[w];
+        if (w == first_word) bits &= ~uint64_t(0) << (begin & 63);
+        if (w == last_word) bits &= ~uint64_t(0) >> (63 - ((end - 1) & 63));
+        while (bits) {
+            fn(w * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+void Grid::clearIgnitions() {
+    for (int idx : ignite_list) {
+        ignite_bits[idx >> 6] = 0;
+    }
+    ignite_list.clear();
+}
+
+void Grid::collectBandLists() {
+    // Bands cover increasing index ranges, so concatenating keeps the lists sorted
+    burning_cells.clear();
+    for (const Band& band : bands) {
+        burning_cells.insert(burning_cells.end(), band.burning.begin(), band.burning.end());
+        
+        // Ignition leaves the fuel count alone: the cell could burn and now is burning
+        burning_count += band.ignited - band.burned_out;
+        burned_count += band.burned_out;
+    }
+    cell_lists_dirty = false;
+    burning_list_stale = false;
+    
+    // A fallback step blocked by water or retardant retries the bitplane
+    // engine once the last suppression timer has run out
+    if (!suppression_expiries.empty()) {
+        had_suppressed = true;
+    } else if (had_suppressed) {
+        had_suppressed = false;
+        if (update_mode == UpdateMode::BITPLANE && bitplane.isBlockedBySuppression()) {
+            bitplane_check_pending = true;
+        }
+    }
+}
+
+void Grid::normalizeCellLists() {
+    // Entries appended by setCell/igniteCell/suppression drops may be out of
+    // order, duplicated or stale by the time the next step runs
+    if (burning_list_stale) {
+        // The bitplane engine does not keep the list; rebuild it from the states
+        burning_cells.clear();
+        for (int y = 0; y < height; ++y) {
+            for (int idx = index(0, y); idx < index(width, y); ++idx) {
+                if (static_cast<CellState>(states[idx]) == CellState::BURNING) {
+                    burning_cells.push_back(idx);
                 }
             }
         }
+        burning_list_stale = false;
+        cell_lists_dirty = true;
     }
+    if (!cell_lists_dirty) return;
+    
+    std::sort(burning_cells.begin(), burning_cells.end());
+    burning_cells.erase(std::unique(burning_cells.begin(), burning_cells.end()), burning_cells.end());
+    burning_cells.erase(std::remove_if(burning_cells.begin(), burning_cells.end(), [&](int idx) {
+        return static_cast<CellState>(states[idx]) != CellState::BURNING;
+    }), burning_cells.end());
+    
+    cell_lists_dirty = false;
 }
 
-void Grid::applyRetardant(int x, int y, int radius, double effectiveness, double duration) {
-    for (int dy = -radius; dy <= radius; ++dy) {
-        for (int dx = -radius; dx <= radius; ++dx) {
-            int target_x = x + dx;
-            int target_y = y + dy;
+void Grid::updateActiveFront(double dt) {
+    normalizeCellLists();
+    
+    // First pass: only burning cells can spread. Each band walks its slice of the
+    // sorted list; draws are keyed by cell, so this matches the full scan exactly.
+    prepareBands(burning_cells);
+    forEachBand([&](int b) {
+        Band& band = bands[b];
+        band.ignitions.clear();
+        if (band.first == band.last) return;
+        for (int i = band.first; i < band.last; ++i) {
+            spreadFromCell(burning_cells[i], dt, [&](int to) { band.ignitions.push_back(to); });
+        }
+    });
+    collectIgnitions();
+    spreadFromHaloSources(dt);
+    
+    // Second pass: visit burning and igniting cells in index order. Suppressed
+    // cells need no visit; their timers are on the wheel.
+    std::sort(ignite_list.begin(), ignite_list.end());
+    touched_cells.clear();
+    std::set_union(burning_cells.begin(), burning_cells.end(),
+                   ignite_list.begin(), ignite_list.end(), std::back_inserter(touched_cells));
+    logChangedCells(touched_cells);
+    expireSuppression();
+    
+    prepareBands(touched_cells);
+    forEachBand([&](int b) {
+        Band& band = bands[b];
+        band.burning.clear();
+        band.ignited = 0;
+        band.burned_out = 0;
+        if (band.first == band.last) return;
+        for (int i = band.first; i < band.last; ++i) {
+            if (isIgnitionPending(touched_cells[i]) && igniteAt(touched_cells[i])) {
+                band.ignited++;
+            }
+        }
+        
+        band.burned_out += advanceBurning(touched_cells, band.first, band.last, dt);
+        
+        for (int i = band.first; i < band.last; ++i) {
+            int idx = touched_cells[i];
+            if (extinguishAt(idx, dt)) {
+                band.burned_out++;
+            }
             
-            if (isValidPosition(target_x, target_y)) {
-                double distance = sqrt(dx*dx + dy*dy);
-                if (distance <= radius) {
-                    SuppressionEffect& effect = suppression_effects[target_y][target_x];
-                    double distance_factor = 1.0 - (distance / radius);
-                    
-                    effect.retardant_level = std::max(effect.retardant_level, 
-                                                    effectiveness * distance_factor);
-                    effect.remaining_time = std::max(effect.remaining_time, duration);
-                }
+            if (static_cast<CellState>(states[idx]) == CellState::BURNING) {
+                band.burning.push_back(idx);
+            }
+        }
+    });
+    collectBandLists();
+    clearIgnitions();
+}
+
+void Grid::applyWaterDrop(int x, int y, int radius, double effectiveness, double duration) {
+    stampFalloff(water_levels, x, y, radius, effectiveness, duration);
+}
+
+void Grid::applyRetardant(int x, int y, int radius, double effectiveness, double duration) {
+    stampFalloff(retardant_levels, x, y, radius, effectiveness, duration);
+}
+
+void Grid::stampFalloff(std::vector<uint8_t>& levels, int x, int y, int radius, double effectiveness,
+                        double duration) {
+    if (radius < 0) return;
+    invalidateBitplane();
+    
+    // Walk the kernel rows clipped to the grid; no distances are computed here
+    double end = duration > 0 ? clock + duration : 0.0;
+    forEachFalloffRow(falloff_kernels.get(radius), x, y, width, height,
+                      [&](int row_y, int dx_begin, int dx_end, const double* factors) {
+        int row = index(x, row_y);
+        for (int dx = dx_begin; dx <= dx_end; ++dx) {
+            int idx = row + dx;
+            levels[idx] = std::max(levels[idx], encodeUnit(effectiveness * factors[dx]));
+            if (end > 0) raiseSuppressionEnd(idx, end);
+        }
+    });
+}
+
+void Grid::raiseSuppressionEnd(int idx, double end) {
+    auto found = suppression_ends.emplace(idx, end);
+    if (found.second || end > found.first->second) {
+        found.first->second = end;
+        suppression_expiries.schedule(end, idx);
+    }
+}
+
+void Grid::applyDrops(const std::vector<SuppressionDrop>& drops) {
+    // Drops whose clipped footprint boxes overlap, directly or through other
+    // drops, form a group. Levels and end times only ever rise to the
+    // strongest drop, so a group can be folded into one box of per-cell
+    // maxima and written once: same levels, same end times, and one timer
+    // per cell instead of one per drop covering it.
+    struct Box {
+        int x0, y0, x1, y1;
+    };
+    std::vector<Box> boxes(drops.size());
+    std::vector<int> groups(drops.size());
+    std::vector<int> on_grid;
+    for (size_t i = 0; i < drops.size(); ++i) {
+        const SuppressionDrop& drop = drops[i];
+        if (drop.radius < 0) continue;
+        invalidateBitplane();   // As stampFalloff does, even for a drop off the grid
+        boxes[i] = Box{std::max(0, drop.x - drop.radius), std::max(0, drop.y - drop.radius),
+                       std::min(width - 1, drop.x + drop.radius), std::min(height - 1, drop.y + drop.radius)};
+        if (boxes[i].x0 > boxes[i].x1 || boxes[i].y0 > boxes[i].y1) continue;
+        groups[i] = static_cast<int>(i);
+        on_grid.push_back(static_cast<int>(i));
+    }
+    
+    auto root = [&](int i) {
+        while (groups[i] != i) i = groups[i] = groups[groups[i]];
+        return i;
+    };
+    for (size_t a = 0; a < on_grid.size(); ++a) {
+        for (size_t b = a + 1; b < on_grid.size(); ++b) {
+            const Box& p = boxes[on_grid[a]];
+            const Box& q = boxes[on_grid[b]];
+            if (p.x0 <= q.x1 && q.x0 <= p.x1 && p.y0 <= q.y1 && q.y0 <= p.y1) {
+                groups[root(on_grid[b])] = root(on_grid[a]);
             }
         }
     }
+    for (int i : on_grid) groups[i] = root(i);
+    std::stable_sort(on_grid.begin(), on_grid.end(), [&](int a, int b) { return groups[a] < groups[b]; });
+    
+    std::vector<int> members;
+    for (size_t first = 0; first < on_grid.size();) {
+        members.clear();
+        Box box = boxes[on_grid[first]];
+        int64_t covered = 0;
+        size_t last = first;
+        for (; last < on_grid.size() && groups[on_grid[last]] == groups[on_grid[first]]; ++last) {
+            const Box& b = boxes[on_grid[last]];
+            box = Box{std::min(box.x0, b.x0), std::min(box.y0, b.y0), std::max(box.x1, b.x1), std::max(box.y1, b.y1)};
+            covered += int64_t(b.x1 - b.x0 + 1) * (b.y1 - b.y0 + 1);
+            members.push_back(on_grid[last]);
+        }
+        first = last;
+        
+        // A lone drop, or a long chain whose box is mostly empty, is cheaper stamped drop by drop
+        int64_t area = int64_t(box.x1 - box.x0 + 1) * (box.y1 - box.y0 + 1);
+        if (members.size() == 1 || area > 4 * covered) {
+            for (int i : members) {
+                const SuppressionDrop& drop = drops[i];
+                stampFalloff(drop.retardant ? retardant_levels : water_levels, drop.x, drop.y, drop.radius,
+                             drop.effectiveness, drop.duration);
+            }
+        } else {
+            foldDrops(drops, members, box.x0, box.y0, box.x1, box.y1);
+        }
+    }
+}
+
+void Grid::foldDrops(const std::vector<SuppressionDrop>& drops, const std::vector<int>& members, int x0, int y0,
+                     int x1, int y1) {
+    // An end of -1 marks a box cell no drop covers
+    int box_width = x1 - x0 + 1;
+    size_t area = static_cast<size_t>(box_width) * (y1 - y0 + 1);
+    fold_water.assign(area, 0);
+    fold_retardant.assign(area, 0);
+    fold_ends.assign(area, -1.0);
+    for (int i : members) {
+        const SuppressionDrop& drop = drops[i];
+        std::vector<uint8_t>& levels = drop.retardant ? fold_retardant : fold_water;
+        double end = drop.duration > 0 ? clock + drop.duration : 0.0;
+        forEachFalloffRow(falloff_kernels.get(drop.radius), drop.x, drop.y, width, height,
+                          [&](int row_y, int dx_begin, int dx_end, const double* factors) {
+            size_t row = static_cast<size_t>(row_y - y0) * box_width + (drop.x - x0);
+            for (int dx = dx_begin; dx <= dx_end; ++dx) {
+                levels[row + dx] = std::max(levels[row + dx], encodeUnit(drop.effectiveness * factors[dx]));
+                fold_ends[row + dx] = std::max(fold_ends[row + dx], end);
+            }
+        });
+    }
+    
+    for (int y = y0; y <= y1; ++y) {
+        size_t fold_row = static_cast<size_t>(y - y0) * box_width;
+        int row = index(x0, y);
+        for (int bx = 0; bx < box_width; ++bx) {
+            size_t cell = fold_row + bx;
+            if (fold_ends[cell] < 0) continue;
+            int idx = row + bx;
+            water_levels[idx] = std::max(water_levels[idx], fold_water[cell]);
+            retardant_levels[idx] = std::max(retardant_levels[idx], fold_retardant[cell]);
+            if (fold_ends[cell] > 0) raiseSuppressionEnd(idx, fold_ends[cell]);
+        }
+    }
 }
 
 void Grid::createFirebreak(int x1, int y1, int x2, int y2) {
@@ -288,8 +1002,8 @@ void Grid::createFirebreak(int x1, int y1, int x2, int y2) {
     
     while (true) {
         if (isValidPosition(x, y)) {
-            suppression_effects[y][x].is_firebreak = true;
-            cells[y][x] = Cell(FuelType::ROCK, 0.0, 0.0);
+            firebreaks[index(x, y)] = 1;
+            setCell(x, y, Cell(FuelType::ROCK, 0.0, 0.0));
         }
         
         if (x == x2 && y == y2) break;
@@ -307,15 +1021,18 @@ void Grid::createFirebreak(int x1, int y1, int x2, int y2) {
 bool Grid::hasSuppressionEffect(int x, int y) const {
     if (!isValidPosition(x, y)) return false;
     
-    const SuppressionEffect& effect = suppression_effects[y][x];
-    return effect.water_level > 0.0 || effect.retardant_level > 0.0 || effect.is_firebreak;
+    int idx = index(x, y);
+    return water_levels[idx] > 0 || retardant_levels[idx] > 0 || firebreaks[idx];
 }
 
 double Grid::getSuppressionModifier(int x, int y) const {
     if (!isValidPosition(x, y)) return 0.0;
     
-    const SuppressionEffect& effect = suppression_effects[y][x];
-    return std::min(1.0, effect.water_level * 0.8 + effect.retardant_level * 0.9);
+    return suppressionModifierAt(index(x, y));
+}
+
+double Grid::suppressionModifierAt(int idx) const {
+    return std::min(1.0, decodeUnit(water_levels[idx]) * 0.8 + decodeUnit(retardant_levels[idx]) * 0.9);
 }
 
 void Grid::displayWithCrews(const HumanFactorManager& human_manager) const {
@@ -327,22 +1044,7 @@ void Grid::displayWithCrews(const HumanFactorManager& human_manager) const {
         std::cout << "|";
         for (int x = 0; x < width; ++x) {
             char crew_char = human_manager.getCrewDisplayChar(x, y);
-            if (crew_char != ' ') {
-                std::cout << crew_char; // Show crew if present
-            } else if (hasSuppressionEffect(x, y)) {
-                const SuppressionEffect& effect = suppression_effects[y][x];
-                if (effect.is_firebreak) {
-                    std::cout << '#'; // Firebreak
-                } else if (effect.water_level > 0.5) {
-                    std::cout << '~'; // Water effect
-                } else if (effect.retardant_level > 0.5) {
-                    std::cout << 'R'; // Retardant effect
-                } else {
-                    std::cout << cells[y][x].getDisplayChar();
-                }
-            } else {
-                std::cout << cells[y][x].getDisplayChar();
-            }
+            std::cout << (crew_char != ' ' ? crew_char : getDisplayChar(x, y)); // Crews show over cells
         }
         std::cout << "|\n";
     }
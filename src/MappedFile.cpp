@@ -0,0 +1,24 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : address(MAP_FAILED), length(0) {
+}
+
+MappedFile::~MappedFile() {
+    if (address != MAP_FAILED) munmap(address, length);
+}
+
+bool MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        length = static_cast<uint64_t>(info.st_size);
+        address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    return address != MAP_FAILED;
+}
@@ -0,0 +1,126 @@
+#include "ProceduralTerrain.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int kFields = 2;              // Elevation, vegetation
+const double kWaterLevel = 0.30;    // Elevation below which a cell is water
+const double kRockLevel = 0.70;     // Elevation above which a cell is rock
+const double kShrubLevel = 0.45;    // Vegetation from which grass gives way to shrub
+const double kTreeLevel = 0.55;     // Vegetation from which shrub gives way to tree
+
+double smooth(double t) {
+    return t * t * (3.0 - 2.0 * t);
+}
+
+uint8_t encodeUnit(double value) {
+    return static_cast<uint8_t>(std::min(1.0, std::max(0.0, value)) * 255.0 + 0.5);
+}
+}
+
+ProceduralTerrain::ProceduralTerrain(uint64_t seed, int feature_size)
+    : rng(seed), feature_size(std::max(feature_size, kMinFeatureSize)) {
+}
+
+double ProceduralTerrain::latticeValue(int field, int octave, int64_t ix, int64_t iy) const {
+    uint64_t bits = CounterRng::bits64(rng.cellKey(static_cast<uint32_t>(iy), static_cast<uint32_t>(ix)),
+                                       CounterRng::PROCEDURAL, static_cast<uint32_t>(field * kOctaves + octave));
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void ProceduralTerrain::generate(int x0, int y0, int w, int h, uint8_t* fuel_types, uint8_t* densities,
+                                 uint8_t* moistures, ptrdiff_t stride) const {
+    const int kLattice = kTileSize + 2;
+    double noise[kFields][kTileSize * kTileSize];
+    double lattice[kLattice * kLattice];
+    double column[kLattice];
+    int64_t column_point[kTileSize];
+    double column_weight[kTileSize];
+
+    double amplitude_sum = 0.0;
+    for (int octave = 0; octave < kOctaves; ++octave) amplitude_sum += 1.0 / (1 << octave);
+
+    for (int tile_y = 0; tile_y < h; tile_y += kTileSize) {
+        for (int tile_x = 0; tile_x < w; tile_x += kTileSize) {
+            int tw = std::min(kTileSize, w - tile_x);
+            int th = std::min(kTileSize, h - tile_y);
+            int first_x = x0 + tile_x;
+            int first_y = y0 + tile_y;
+
+            for (int field = 0; field < kFields; ++field) {
+                std::fill(noise[field], noise[field] + tw * th, 0.0);
+                for (int octave = 0; octave < kOctaves; ++octave) {
+                    double spacing = static_cast<double>(feature_size) / (1 << octave);
+                    double amplitude = 1.0 / (1 << octave);
+
+                    // Lattice points around the tile, then bilinear weights per column and row
+                    int64_t ix0 = static_cast<int64_t>(std::floor((first_x + 0.5) / spacing));
+                    int64_t iy0 = static_cast<int64_t>(std::floor((first_y + 0.5) / spacing));
+                    int64_t ix1 = static_cast<int64_t>(std::floor((first_x + tw - 0.5) / spacing)) + 1;
+                    int64_t iy1 = static_cast<int64_t>(std::floor((first_y + th - 0.5) / spacing)) + 1;
+                    int points_x = static_cast<int>(ix1 - ix0 + 1);
+                    for (int64_t iy = iy0; iy <= iy1; ++iy) {
+                        for (int64_t ix = ix0; ix <= ix1; ++ix) {
+                            lattice[(iy - iy0) * points_x + (ix - ix0)] = latticeValue(field, octave, ix, iy);
+                        }
+                    }
+                    for (int x = 0; x < tw; ++x) {
+                        double u = (first_x + x + 0.5) / spacing;
+                        double point = std::floor(u);
+                        column_point[x] = static_cast<int64_t>(point) - ix0;
+                        column_weight[x] = smooth(u - point);
+                    }
+
+                    // Separable: down each lattice column once per row, then across per cell
+                    for (int y = 0; y < th; ++y) {
+                        double v = (first_y + y + 0.5) / spacing;
+                        double point = std::floor(v);
+                        double row_weight = smooth(v - point);
+                        const double* top = lattice + (static_cast<int64_t>(point) - iy0) * points_x;
+                        const double* bottom = top + points_x;
+                        for (int c = 0; c < points_x; ++c) {
+                            column[c] = top[c] + (bottom[c] - top[c]) * row_weight;
+                        }
+                        double* out = noise[field] + y * tw;
+                        for (int x = 0; x < tw; ++x) {
+                            const double* left = column + column_point[x];
+                            out[x] += amplitude * (left[0] + (left[1] - left[0]) * column_weight[x]);
+                        }
+                    }
+                }
+            }
+
+            for (int y = 0; y < th; ++y) {
+                ptrdiff_t row = (tile_y + y) * stride + tile_x;
+                for (int x = 0; x < tw; ++x) {
+                    double elevation = noise[0][y * tw + x] / amplitude_sum;
+                    double vegetation = noise[1][y * tw + x] / amplitude_sum;
+
+                    FuelType type;
+                    if (elevation < kWaterLevel) {
+                        type = FuelType::WATER;
+                    } else if (elevation > kRockLevel) {
+                        type = FuelType::ROCK;
+                    } else if (vegetation < kShrubLevel) {
+                        type = FuelType::GRASS;
+                    } else if (vegetation < kTreeLevel) {
+                        type = FuelType::SHRUB;
+                    } else {
+                        type = FuelType::TREE;
+                    }
+                    // Water and rock have no fuel, as in the Cell constructor
+                    bool burnable = type != FuelType::WATER && type != FuelType::ROCK;
+                    fuel_types[row + x] = static_cast<uint8_t>(type);
+                    densities[row + x] = burnable ? encodeUnit(0.3 + 0.7 * (vegetation - 0.2) / 0.6) : 0;
+                    moistures[row + x] = encodeUnit(0.1 + 0.5 * (kRockLevel - elevation) / (kRockLevel - kWaterLevel));
+                }
+            }
+        }
+    }
+}
+
+Cell ProceduralTerrain::cellAt(int x, int y) const {
+    uint8_t type, density, moisture;
+    generate(x, y, 1, 1, &type, &density, &moisture, 1);
+    return Cell(static_cast<FuelType>(type), density / 255.0, moisture / 255.0);
+}
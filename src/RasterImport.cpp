@@ -0,0 +1,481 @@
+#include "RasterImport.h"
+#include "FuelLayer.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace {
+const size_t kNoError = std::numeric_limits<size_t>::max();
+const size_t kChunkCells = size_t(1) << 20;     // Binary values per task
+const size_t kChunkBytes = size_t(1) << 22;     // ASCII text per task
+
+const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+bool hostIsBigEndian() {
+    uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 0;
+}
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// Extension including the dot, lowercased; empty if the file name has none
+std::string extensionOf(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return std::string();
+    return lowercase(path.substr(dot));
+}
+
+// Decimal numbers of up to 15 digits are assembled exactly and divided once,
+// which rounds the same as from_chars; anything else goes to from_chars
+bool parseNumber(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction_digits = 0;
+    while (p != end && *p >= '0' && *p <= '9') {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p++ - '0');
+        ++digits;
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && *p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p++ - '0');
+            ++digits;
+            ++fraction_digits;
+        }
+    }
+    if (p == end && digits > 0 && digits <= 15) {
+        value = static_cast<double>(mantissa) / kPow10[fraction_digits];
+        if (negative) value = -value;
+        return true;
+    }
+
+    const char* start = begin != end && *begin == '+' ? begin + 1 : begin;
+    std::from_chars_result result = std::from_chars(start, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// Turns raster values into the bytes FuelLayer stores
+struct Encoder {
+    RasterImport::Field field;
+    bool has_nodata;
+    double nodata;
+
+    // False when a fuel type value is not one of the FuelType codes
+    bool encode(double value, uint8_t& out) const {
+        if (std::isnan(value) || (has_nodata && value == nodata)) {
+            switch (field) {
+                case RasterImport::Field::FUEL_TYPE: out = static_cast<uint8_t>(FuelType::ROCK); break;
+                case RasterImport::Field::DENSITY: out = 0; break;
+                case RasterImport::Field::MOISTURE: out = 255; break;
+            }
+            return true;
+        }
+        if (field == RasterImport::Field::FUEL_TYPE) {
+            if (!(value >= 0.0 && value <= static_cast<double>(FuelType::ROCK)) || value != std::floor(value)) {
+                return false;
+            }
+            out = static_cast<uint8_t>(value);
+            return true;
+        }
+        // Same rounding as Grid's stored fractions
+        out = static_cast<uint8_t>(std::min(1.0, std::max(0.0, value)) * 255.0 + 0.5);
+        return true;
+    }
+};
+
+template <typename Task>
+void forEachChunk(ThreadPool* pool, int count, const Task& task) {
+    if (pool) {
+        pool->parallelFor(count, task);
+    } else {
+        for (int i = 0; i < count; ++i) task(i);
+    }
+}
+
+// Returns the index of the first value encode rejects, or kNoError
+template <typename T, bool kSwap>
+size_t convertValues(const char* source, size_t count, Encoder encoder, uint8_t* out) {
+    // A float raster's NODATA is only equal to itself at the raster's precision
+    if (sizeof(T) == 4 && std::is_floating_point<T>::value &&
+        std::fabs(encoder.nodata) <= std::numeric_limits<float>::max()) {
+        encoder.nodata = static_cast<float>(encoder.nodata);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, source + i * sizeof(T), sizeof(T));
+        if (kSwap) std::reverse(bytes, bytes + sizeof(T));
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        if (!encoder.encode(static_cast<double>(value), out[i])) return i;
+    }
+    return kNoError;
+}
+
+template <bool kSwap>
+size_t convertElements(const RasterImport::Header& header, const char* source, size_t count,
+                       const Encoder& encoder, uint8_t* out) {
+    if (header.is_float) {
+        if (header.element_bytes == 4) return convertValues<float, kSwap>(source, count, encoder, out);
+        return convertValues<double, kSwap>(source, count, encoder, out);
+    }
+    switch (header.element_bytes) {
+        case 1:
+            if (header.is_signed) return convertValues<int8_t, kSwap>(source, count, encoder, out);
+            return convertValues<uint8_t, kSwap>(source, count, encoder, out);
+        case 2:
+            if (header.is_signed) return convertValues<int16_t, kSwap>(source, count, encoder, out);
+            return convertValues<uint16_t, kSwap>(source, count, encoder, out);
+        default:
+            if (header.is_signed) return convertValues<int32_t, kSwap>(source, count, encoder, out);
+            return convertValues<uint32_t, kSwap>(source, count, encoder, out);
+    }
+}
+
+// Reads the "key value" lines of an ESRI ASCII grid up to the first value
+bool parseAsciiHeader(const std::string& path, const char* data, size_t size, RasterImport::Header& header,
+                      size_t& body, std::string& error) {
+    header = RasterImport::Header{0, 0, false, 0.0, 0, false, false, false, 0};
+    size_t p = 0;
+    while (true) {
+        while (p < size && isSpace(data[p])) ++p;
+        if (p == size || std::isdigit(static_cast<unsigned char>(data[p])) || data[p] == '-' ||
+            data[p] == '+' || data[p] == '.') {
+            break;
+        }
+        size_t key_end = p;
+        while (key_end < size && !isSpace(data[key_end])) ++key_end;
+        std::string key = lowercase(std::string(data + p, key_end - p));
+        size_t value_begin = key_end;
+        while (value_begin < size && (data[value_begin] == ' ' || data[value_begin] == '\t')) ++value_begin;
+        size_t value_end = value_begin;
+        while (value_end < size && !isSpace(data[value_end])) ++value_end;
+
+        double value;
+        if (!parseNumber(data + value_begin, data + value_end, value)) {
+            error = path + ": header line " + key + " has no numeric value";
+            return false;
+        }
+        if (key == "ncols" || key == "nrows") {
+            if (!(value >= 1.0 && value <= std::numeric_limits<int>::max()) || value != std::floor(value)) {
+                error = path + ": " + key + " must be a positive integer";
+                return false;
+            }
+            (key == "ncols" ? header.width : header.height) = static_cast<int>(value);
+        } else if (key == "nodata_value") {
+            header.has_nodata = true;
+            header.nodata = value;
+        } else if (key != "xllcorner" && key != "xllcenter" && key != "yllcorner" && key != "yllcenter" &&
+                   key != "cellsize" && key != "dx" && key != "dy") {
+            error = path + ": unknown header key " + key;
+            return false;
+        }
+        p = value_end;
+    }
+    if (header.width == 0 || header.height == 0) {
+        error = path + " has no ncols or nrows";
+        return false;
+    }
+    body = p;
+    return true;
+}
+} // namespace
+
+bool RasterImport::isAsciiPath(const std::string& path) {
+    return extensionOf(path) == ".asc";
+}
+
+std::string RasterImport::headerPath(const std::string& path) {
+    std::string extension = extensionOf(path);
+    return path.substr(0, path.size() - extension.size()) + ".hdr";
+}
+
+bool RasterImport::readHeader(const std::string& path, Header& header, std::string& error) {
+    if (isAsciiPath(path)) {
+        MappedFile file;
+        if (!file.open(path)) {
+            error = "cannot open " + path;
+            return false;
+        }
+        size_t body;
+        return parseAsciiHeader(path, file.data(), file.size(), header, body, error);
+    }
+
+    std::string hdr_path = headerPath(path);
+    std::ifstream file(hdr_path);
+    if (!file.is_open()) {
+        error = "cannot open " + hdr_path + ", the header of " + path;
+        return false;
+    }
+    header = Header{0, 0, false, 0.0, 1, false, false, false, 0};
+    int nbits = 8;
+    std::string pixel_type = "unsignedint";
+    bool big_endian = false;
+    long long row_bytes = -1;
+    std::string key, value;
+    while (file >> key >> value) {
+        key = lowercase(key);
+        value = lowercase(value);
+        double number = 0.0;
+        bool numeric = parseNumber(value.data(), value.data() + value.size(), number);
+        if (key == "ncols" || key == "nrows" || key == "nbits" || key == "nbands" || key == "skipbytes" ||
+            key == "totalrowbytes" || key == "bandrowbytes") {
+            if (!numeric || number < 0.0 || number > std::numeric_limits<int>::max() ||
+                number != std::floor(number)) {
+                error = hdr_path + ": " + key + " must be a non-negative integer";
+                return false;
+            }
+        }
+        if (key == "ncols") {
+            header.width = static_cast<int>(number);
+        } else if (key == "nrows") {
+            header.height = static_cast<int>(number);
+        } else if (key == "nbits") {
+            nbits = static_cast<int>(number);
+        } else if (key == "nbands" && number != 1.0) {
+            error = hdr_path + ": only single-band rasters are supported";
+            return false;
+        } else if (key == "skipbytes") {
+            header.skip_bytes = static_cast<uint64_t>(number);
+        } else if (key == "totalrowbytes" || key == "bandrowbytes") {
+            row_bytes = static_cast<long long>(number);
+        } else if (key == "pixeltype") {
+            pixel_type = value;
+        } else if (key == "byteorder") {
+            if (value != "lsbfirst" && value != "msbfirst" && value != "i" && value != "m") {
+                error = hdr_path + ": unknown byteorder " + value;
+                return false;
+            }
+            big_endian = value == "msbfirst" || value == "m";
+        } else if (key == "nodata" || key == "nodata_value") {
+            if (!numeric) {
+                error = hdr_path + ": " + key + " must be a number";
+                return false;
+            }
+            header.has_nodata = true;
+            header.nodata = number;
+        }
+    }
+
+    if (extensionOf(path) == ".flt") {
+        nbits = 32;
+        pixel_type = "float";
+    }
+    header.is_float = pixel_type == "float";
+    header.is_signed = pixel_type == "signedint";
+    if (!header.is_float && !header.is_signed && pixel_type != "unsignedint") {
+        error = hdr_path + ": unknown pixeltype " + pixel_type;
+        return false;
+    }
+    if (header.is_float ? nbits != 32 && nbits != 64 : nbits != 8 && nbits != 16 && nbits != 32) {
+        error = hdr_path + ": " + std::to_string(nbits) + "-bit " + pixel_type + " pixels are not supported";
+        return false;
+    }
+    header.element_bytes = nbits / 8;
+    header.swap_bytes = header.element_bytes > 1 && big_endian != hostIsBigEndian();
+    if (header.width == 0 || header.height == 0) {
+        error = hdr_path + " has no ncols or nrows";
+        return false;
+    }
+    if (row_bytes >= 0 && row_bytes != static_cast<long long>(header.width) * header.element_bytes) {
+        error = hdr_path + ": padded rows are not supported";
+        return false;
+    }
+    return true;
+}
+
+bool RasterImport::readBinary(const std::string& path, const Header& header, Field field, ThreadPool* pool,
+                              uint8_t* out, std::string& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    size_t cells = static_cast<size_t>(header.width) * header.height;
+    uint64_t expected = header.skip_bytes + static_cast<uint64_t>(cells) * header.element_bytes;
+    if (file.size() != expected) {
+        error = path + " has " + std::to_string(file.size()) + " bytes, its header describes " +
+                std::to_string(expected);
+        return false;
+    }
+
+    Encoder encoder{field, header.has_nodata, header.nodata};
+    const char* values = file.data() + header.skip_bytes;
+    int chunks = static_cast<int>((cells + kChunkCells - 1) / kChunkCells);
+    std::vector<size_t> bad(chunks, kNoError);
+    forEachChunk(pool, chunks, [&](int chunk) {
+        size_t begin = static_cast<size_t>(chunk) * kChunkCells;
+        size_t count = std::min(kChunkCells, cells - begin);
+        const char* source = values + begin * header.element_bytes;
+        size_t first = header.swap_bytes ? convertElements<true>(header, source, count, encoder, out + begin)
+                                         : convertElements<false>(header, source, count, encoder, out + begin);
+        if (first != kNoError) bad[chunk] = begin + first;
+    });
+
+    size_t first_bad = *std::min_element(bad.begin(), bad.end());
+    if (first_bad != kNoError) {
+        error = path + ": value at row " + std::to_string(first_bad / header.width) + ", column " +
+                std::to_string(first_bad % header.width) + " is not a fuel type code 0-4";
+        return false;
+    }
+    return true;
+}
+
+bool RasterImport::readAscii(const std::string& path, Field field, int width, int height, ThreadPool* pool,
+                             uint8_t* out, std::string& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    Header header;
+    size_t body;
+    if (!parseAsciiHeader(path, file.data(), file.size(), header, body, error)) return false;
+    if (header.width != width || header.height != height) {
+        error = path + " changed size while it was read";
+        return false;
+    }
+
+    // Chunk boundaries are moved onto whitespace so no value is split
+    const char* data = file.data();
+    size_t size = file.size();
+    int chunks = static_cast<int>((size - body) / kChunkBytes + 1);
+    std::vector<size_t> starts(chunks + 1);
+    starts[0] = body;
+    starts[chunks] = size;
+    for (int i = 1; i < chunks; ++i) {
+        size_t p = std::max(starts[i - 1], body + (size - body) / chunks * i);
+        while (p < size && !isSpace(data[p])) ++p;
+        starts[i] = p;
+    }
+
+    // First pass: how many values each chunk holds
+    std::vector<size_t> first_cell(chunks + 1, 0);
+    forEachChunk(pool, chunks, [&](int chunk) {
+        size_t count = 0;
+        bool in_value = false;
+        for (size_t p = starts[chunk]; p < starts[chunk + 1]; ++p) {
+            bool space = isSpace(data[p]);
+            count += !space && !in_value;
+            in_value = !space;
+        }
+        first_cell[chunk + 1] = count;
+    });
+    for (int i = 0; i < chunks; ++i) first_cell[i + 1] += first_cell[i];
+    size_t cells = static_cast<size_t>(width) * height;
+    if (first_cell[chunks] != cells) {
+        error = path + " has " + std::to_string(first_cell[chunks]) + " values, ncols x nrows is " +
+                std::to_string(cells);
+        return false;
+    }
+
+    // Second pass: parse and encode straight into the layer
+    Encoder encoder{field, header.has_nodata, header.nodata};
+    std::vector<size_t> bad(chunks, kNoError);
+    std::vector<char> malformed(chunks, 0);
+    forEachChunk(pool, chunks, [&](int chunk) {
+        size_t cell = first_cell[chunk];
+        const char* p = data + starts[chunk];
+        const char* end = data + starts[chunk + 1];
+        while (true) {
+            while (p != end && isSpace(*p)) ++p;
+            if (p == end) break;
+            const char* value_end = p;
+            while (value_end != end && !isSpace(*value_end)) ++value_end;
+            double value;
+            if (!parseNumber(p, value_end, value)) {
+                bad[chunk] = cell;
+                malformed[chunk] = 1;
+                return;
+            }
+            if (!encoder.encode(value, out[cell])) {
+                bad[chunk] = cell;
+                return;
+            }
+            ++cell;
+            p = value_end;
+        }
+    });
+
+    int first_chunk = static_cast<int>(std::min_element(bad.begin(), bad.end()) - bad.begin());
+    size_t first_bad = bad[first_chunk];
+    if (first_bad != kNoError) {
+        error = path + ": value at row " + std::to_string(first_bad / width) + ", column " +
+                std::to_string(first_bad % width) +
+                (malformed[first_chunk] ? " is not a number" : " is not a fuel type code 0-4");
+        return false;
+    }
+    return true;
+}
+
+bool RasterImport::load(const std::string& fuel_path, const std::string& density_path,
+                        const std::string& moisture_path, ThreadPool* pool, FuelLayer& layer, std::string& error) {
+    if (fuel_path.empty()) {
+        error = "no fuel type raster given";
+        return false;
+    }
+    
+    // Sizes first, so a mismatch is reported before anything is converted
+    const std::string* paths[3] = {&fuel_path, &density_path, &moisture_path};
+    Header headers[3];
+    for (int i = 0; i < 3; ++i) {
+        if (paths[i]->empty()) continue;
+        if (!readHeader(*paths[i], headers[i], error)) return false;
+        if (headers[i].width != headers[0].width || headers[i].height != headers[0].height) {
+            error = *paths[i] + " is " + std::to_string(headers[i].width) + "x" +
+                    std::to_string(headers[i].height) + ", " + fuel_path + " is " +
+                    std::to_string(headers[0].width) + "x" + std::to_string(headers[0].height);
+            return false;
+        }
+    }
+
+    int width = headers[0].width;
+    int height = headers[0].height;
+    size_t cells = static_cast<size_t>(width) * height;
+    FuelLayer result(FuelLayer::Kind::RASTER, width, height);
+    std::vector<uint8_t>* fields[3] = {&result.fuel_types, &result.fuel_densities, &result.moistures};
+    const Cell defaults;
+    uint8_t default_bytes[3] = {0, 0, 0};
+    Encoder{Field::DENSITY, false, 0.0}.encode(defaults.getFuelDensity(), default_bytes[1]);
+    Encoder{Field::MOISTURE, false, 0.0}.encode(defaults.getMoisture(), default_bytes[2]);
+
+    for (int i = 0; i < 3; ++i) {
+        std::vector<uint8_t>& field = *fields[i];
+        if (paths[i]->empty()) {
+            field.assign(cells, default_bytes[i]);
+            continue;
+        }
+        field.resize(cells);
+        Field kind = static_cast<Field>(i);
+        bool ok = isAsciiPath(*paths[i]) ? readAscii(*paths[i], kind, width, height, pool, field.data(), error)
+                                         : readBinary(*paths[i], headers[i], kind, pool, field.data(), error);
+        if (!ok) return false;
+    }
+
+    layer = std::move(result);
+    return true;
+}
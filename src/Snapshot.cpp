@@ -0,0 +1,446 @@
+#include "Snapshot.h"
+#include "FireSimulation.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+const char kMagic[8] = {'W', 'F', 'S', 'N', 'A', 'P', '\r', '\n'};
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+}
+
+uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Scalars are appended in native byte order; strings are length-prefixed
+class MetadataWriter {
+private:
+    std::string buffer;
+
+public:
+    template <typename T>
+    void put(T value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putString(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    const std::string& data() const { return buffer; }
+};
+
+// Every read checks the bounds; the first overrun makes ok() false for good
+class MetadataReader {
+private:
+    const char* data;
+    uint64_t size;
+    uint64_t position;
+    bool valid;
+
+public:
+    MetadataReader(const char* bytes, uint64_t count) : data(bytes), size(count), position(0), valid(true) {}
+
+    template <typename T>
+    T get() {
+        T value{};
+        if (valid && size - position >= sizeof(value)) {
+            std::memcpy(&value, data + position, sizeof(value));
+            position += sizeof(value);
+        } else {
+            valid = false;
+        }
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        if (!valid || size - position < length) {
+            valid = false;
+            return std::string();
+        }
+        std::string value(data + position, length);
+        position += length;
+        return value;
+    }
+
+    bool ok() const { return valid; }
+    bool atEnd() const { return position == size; }
+};
+}
+
+uint64_t SnapshotIO::checksum(const void* data, uint64_t bytes) {
+    // Four independent multiply-rotate lanes over 8-byte words (the xxHash64
+    // round), so large arrays are hashed at memory speed
+    const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    const unsigned char* bytes_in = static_cast<const unsigned char*>(data);
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+
+    uint64_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, bytes_in + i + lane * 8, sizeof(word));
+            lanes[lane] = rotateLeft(lanes[lane] + word * kPrime2, 31) * kPrime1;
+        }
+    }
+
+    uint64_t hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) +
+                    rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18) + bytes;
+    for (; i < bytes; ++i) {
+        hash = rotateLeft(hash ^ (bytes_in[i] * kPrime1), 11) * kPrime2;
+    }
+    return CounterRng::mix64(hash);
+}
+
+template <typename GridType, typename Fn>
+void SnapshotIO::forEachField(GridType& grid, Fn&& fn) {
+    fn("states", grid.states);
+    fn("fuel_types", grid.fuel_types);
+    fn("fuel_densities", grid.fuel_densities);
+    fn("moistures", grid.moistures);
+    fn("temperatures", grid.temperatures);
+    fn("burn_times", grid.burn_times);
+    fn("ignition_probabilities", grid.ignition_probabilities);
+    fn("water_levels", grid.water_levels);
+    fn("retardant_levels", grid.retardant_levels);
+    fn("firebreaks", grid.firebreaks);
+}
+
+bool SnapshotIO::save(const FireSimulation& sim, const std::string& path, std::string& error) {
+    const Grid& grid = sim.grid;
+    const HumanFactorManager& human = sim.human_manager;
+
+    MetadataWriter meta;
+    meta.put(sim.time_step);
+    meta.put(sim.total_time);
+    meta.put(grid.wind_speed);
+    meta.put(grid.wind_direction);
+    meta.put(grid.ambient_temp);
+    meta.put(grid.humidity);
+    meta.put(static_cast<uint8_t>(grid.spread_stencil));
+    meta.put(static_cast<uint8_t>(grid.update_mode));
+    meta.put(grid.rng.getSeed());
+    meta.put(grid.step_count);
+    meta.put(grid.clock);
+    // Sorted, so the same grid always gives the same file
+    std::vector<std::pair<int, double>> ends(grid.suppression_ends.begin(), grid.suppression_ends.end());
+    std::sort(ends.begin(), ends.end());
+    meta.put(static_cast<uint32_t>(ends.size()));
+    for (const std::pair<int, double>& end : ends) {
+        meta.put(static_cast<int32_t>(end.first));
+        meta.put(end.second);
+    }
+
+    meta.put(human.total_budget);
+    meta.put(human.spent_budget);
+    meta.put(static_cast<int32_t>(human.next_crew_id));
+    meta.put(static_cast<uint32_t>(human.crews.size()));
+    for (const FirefightingCrew& crew : human.crews) {
+        meta.put(static_cast<int32_t>(crew.id));
+        meta.putString(crew.name);
+        meta.put(static_cast<uint8_t>(crew.type));
+        meta.put(static_cast<int32_t>(crew.x));
+        meta.put(static_cast<int32_t>(crew.y));
+        meta.put(crew.water_capacity);
+        meta.put(crew.retardant_capacity);
+        meta.put(crew.current_water);
+        meta.put(crew.current_retardant);
+        meta.put(crew.effectiveness);
+        meta.put(crew.fatigue);
+        meta.put(static_cast<uint8_t>(crew.available));
+        meta.put(crew.speed);
+    }
+    meta.put(static_cast<uint32_t>(human.evacuation_zones.size()));
+    for (const EvacuationZone& zone : human.evacuation_zones) {
+        meta.put(static_cast<int32_t>(zone.x));
+        meta.put(static_cast<int32_t>(zone.y));
+        meta.put(static_cast<int32_t>(zone.radius));
+        meta.put(static_cast<int32_t>(zone.population));
+        meta.put(static_cast<int32_t>(zone.evacuated));
+        meta.put(static_cast<uint8_t>(zone.evacuation_ordered));
+        meta.put(zone.danger_level);
+        meta.putString(zone.name);
+    }
+    const std::vector<SuppressionAction>& actions = sim.suppression_queue.getPending();
+    meta.put(static_cast<uint32_t>(actions.size()));
+    for (const SuppressionAction& action : actions) {
+        meta.put(static_cast<uint8_t>(action.type));
+        meta.put(static_cast<int32_t>(action.x));
+        meta.put(static_cast<int32_t>(action.y));
+        meta.put(static_cast<int32_t>(action.end_x));
+        meta.put(static_cast<int32_t>(action.end_y));
+        meta.put(static_cast<int32_t>(action.radius));
+        meta.put(action.effectiveness);
+        meta.put(action.duration);
+        meta.put(action.cost);
+    }
+
+    // Field table first, so the header knows where everything goes
+    std::vector<SnapshotField> fields;
+    std::vector<const char*> field_data;
+    uint64_t table_bytes = sizeof(SnapshotHeader);
+    forEachField(grid, [&](const char*, const auto&) { table_bytes += sizeof(SnapshotField); });
+    uint64_t offset = alignUp(table_bytes);
+    uint32_t header_bytes = static_cast<uint32_t>(offset);
+
+    forEachField(grid, [&](const char* name, const auto& array) {
+        SnapshotField field;
+        std::memset(&field, 0, sizeof(field));
+        std::strncpy(field.name, name, sizeof(field.name) - 1);
+        field.element_bytes = sizeof(array[0]);
+        field.offset = offset;
+        field.bytes = array.size() * sizeof(array[0]);
+        field.checksum = checksum(array.data(), field.bytes);
+        fields.push_back(field);
+        field_data.push_back(reinterpret_cast<const char*>(array.data()));
+        offset = alignUp(offset + field.bytes);
+    });
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.byte_order = kSnapshotByteOrder;
+    header.header_bytes = header_bytes;
+    header.field_count = static_cast<uint32_t>(fields.size());
+    header.width = grid.width;
+    header.height = grid.height;
+    header.halo = Grid::kHalo;
+    header.stride = grid.stride;
+    header.metadata_offset = offset;
+    header.metadata_bytes = meta.data().size();
+    header.metadata_checksum = checksum(meta.data().data(), meta.data().size());
+    header.file_bytes = offset + meta.data().size();
+
+    std::vector<char> head(header_bytes, 0);
+    std::memcpy(head.data(), &header, sizeof(header));
+    std::memcpy(head.data() + sizeof(header), fields.data(), fields.size() * sizeof(SnapshotField));
+    header.checksum = checksum(head.data(), head.size());
+    std::memcpy(head.data(), &header, sizeof(header));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+    file.write(head.data(), head.size());
+    std::vector<char> padding(kSnapshotAlignment, 0);
+    for (size_t f = 0; f < fields.size(); ++f) {
+        file.write(field_data[f], static_cast<std::streamsize>(fields[f].bytes));
+        uint64_t end = fields[f].offset + fields[f].bytes;
+        file.write(padding.data(), static_cast<std::streamsize>(alignUp(end) - end));
+    }
+    file.write(meta.data().data(), static_cast<std::streamsize>(meta.data().size()));
+    file.close();
+    if (file.fail()) {
+        error = "error writing " + path;
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotIO::load(FireSimulation& sim, const std::string& path, std::string& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // Header: identity, layout and its own checksum
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        error = path + " is too short for a snapshot";
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a snapshot";
+        return false;
+    }
+    if (header.byte_order != kSnapshotByteOrder) {
+        error = path + " was written with a different byte order";
+        return false;
+    }
+    if (header.version != kSnapshotVersion) {
+        error = path + " has snapshot version " + std::to_string(header.version) +
+                ", expected " + std::to_string(kSnapshotVersion);
+        return false;
+    }
+    uint64_t table_end = sizeof(header) + static_cast<uint64_t>(header.field_count) * sizeof(SnapshotField);
+    if (header.file_bytes != file.size() || header.header_bytes < table_end ||
+        header.header_bytes > file.size() || header.width <= 0 || header.height <= 0 ||
+        header.halo != Grid::kHalo || !Grid::fitsIndex(header.width, header.height) ||
+        header.stride != header.width + 2 * Grid::kHalo) {
+        error = path + " has an inconsistent header";
+        return false;
+    }
+    std::vector<char> head(file.data(), file.data() + header.header_bytes);
+    std::memset(head.data() + offsetof(SnapshotHeader, checksum), 0, sizeof(header.checksum));
+    if (checksum(head.data(), head.size()) != header.checksum) {
+        error = path + ": header checksum mismatch";
+        return false;
+    }
+    std::vector<SnapshotField> table(header.field_count);
+    std::memcpy(table.data(), file.data() + sizeof(header), table.size() * sizeof(SnapshotField));
+
+    // Every field this build needs must be present with the expected size and
+    // an intact checksum; fields this build does not know are skipped
+    uint64_t cell_count = static_cast<uint64_t>(header.stride) * (header.height + 2 * header.halo);
+    std::vector<const SnapshotField*> sources;
+    bool fields_ok = true;
+    forEachField(sim.grid, [&](const char* name, const auto& array) {
+        if (!fields_ok) return;
+        const SnapshotField* found = nullptr;
+        for (const SnapshotField& field : table) {
+            if (std::strncmp(field.name, name, sizeof(field.name)) == 0) found = &field;
+        }
+        if (!found) {
+            error = path + " has no " + name + " array";
+            fields_ok = false;
+        } else if (found->element_bytes != sizeof(array[0]) || found->bytes != cell_count * sizeof(array[0]) ||
+                   found->offset % kSnapshotAlignment != 0 || found->offset > file.size() ||
+                   found->bytes > file.size() - found->offset) {
+            error = path + ": " + name + " array has the wrong size or position";
+            fields_ok = false;
+        } else if (checksum(file.data() + found->offset, found->bytes) != found->checksum) {
+            error = path + ": " + name + " checksum mismatch";
+            fields_ok = false;
+        }
+        sources.push_back(found);
+    });
+    if (!fields_ok) return false;
+
+    // Metadata is read into temporaries so a bad file leaves the simulation alone
+    if (header.metadata_offset > file.size() || header.metadata_bytes > file.size() - header.metadata_offset ||
+        checksum(file.data() + header.metadata_offset, header.metadata_bytes) != header.metadata_checksum) {
+        error = path + ": metadata checksum mismatch";
+        return false;
+    }
+    MetadataReader meta(file.data() + header.metadata_offset, header.metadata_bytes);
+    double time_step = meta.get<double>();
+    double total_time = meta.get<double>();
+    double wind_speed = meta.get<double>();
+    double wind_direction = meta.get<double>();
+    double ambient_temp = meta.get<double>();
+    double humidity = meta.get<double>();
+    uint8_t stencil = meta.get<uint8_t>();
+    uint8_t mode = meta.get<uint8_t>();
+    uint64_t seed = meta.get<uint64_t>();
+    uint32_t step_count = meta.get<uint32_t>();
+    double clock = meta.get<double>();
+    std::unordered_map<int, double> suppression_ends;
+    bool ends_valid = true;
+    uint32_t end_count = meta.get<uint32_t>();
+    for (uint32_t e = 0; e < end_count && meta.ok(); ++e) {
+        int32_t idx = meta.get<int32_t>();
+        double end = meta.get<double>();
+        ends_valid = ends_valid && idx >= 0 && static_cast<uint64_t>(idx) < cell_count && end > 0 &&
+                     suppression_ends.emplace(idx, end).second;
+    }
+
+    HumanFactorManager human;
+    human.total_budget = meta.get<double>();
+    human.spent_budget = meta.get<double>();
+    human.next_crew_id = meta.get<int32_t>();
+    uint32_t crew_count = meta.get<uint32_t>();
+    for (uint32_t c = 0; c < crew_count && meta.ok(); ++c) {
+        int id = meta.get<int32_t>();
+        std::string name = meta.getString();
+        CrewType type = static_cast<CrewType>(meta.get<uint8_t>());
+        int x = meta.get<int32_t>();
+        int y = meta.get<int32_t>();
+        FirefightingCrew crew(id, name, type, x, y);
+        crew.water_capacity = meta.get<double>();
+        crew.retardant_capacity = meta.get<double>();
+        crew.current_water = meta.get<double>();
+        crew.current_retardant = meta.get<double>();
+        crew.effectiveness = meta.get<double>();
+        crew.fatigue = meta.get<double>();
+        crew.available = meta.get<uint8_t>() != 0;
+        crew.speed = meta.get<double>();
+        human.crews.push_back(crew);
+    }
+    uint32_t zone_count = meta.get<uint32_t>();
+    for (uint32_t z = 0; z < zone_count && meta.ok(); ++z) {
+        EvacuationZone zone;
+        zone.x = meta.get<int32_t>();
+        zone.y = meta.get<int32_t>();
+        zone.radius = meta.get<int32_t>();
+        zone.population = meta.get<int32_t>();
+        zone.evacuated = meta.get<int32_t>();
+        zone.evacuation_ordered = meta.get<uint8_t>() != 0;
+        zone.danger_level = meta.get<double>();
+        zone.name = meta.getString();
+        human.evacuation_zones.push_back(zone);
+    }
+    std::vector<SuppressionAction> actions;
+    bool actions_valid = true;
+    uint32_t action_count = meta.get<uint32_t>();
+    for (uint32_t a = 0; a < action_count && meta.ok(); ++a) {
+        SuppressionAction action;
+        uint8_t type = meta.get<uint8_t>();
+        action.type = static_cast<SuppressionType>(type);
+        action.x = meta.get<int32_t>();
+        action.y = meta.get<int32_t>();
+        action.end_x = meta.get<int32_t>();
+        action.end_y = meta.get<int32_t>();
+        action.radius = meta.get<int32_t>();
+        action.effectiveness = meta.get<double>();
+        action.duration = meta.get<double>();
+        action.cost = meta.get<double>();
+        actions_valid = actions_valid && type <= static_cast<uint8_t>(SuppressionType::EVACUATION);
+        actions.push_back(action);
+    }
+    if (!meta.ok() || !meta.atEnd() || !ends_valid || !actions_valid || stencil > static_cast<uint8_t>(SpreadStencil::EXTENDED_24) ||
+        mode > static_cast<uint8_t>(UpdateMode::BITPLANE)) {
+        error = path + " has malformed metadata";
+        return false;
+    }
+
+    // Everything checked out: one bulk copy per array, then the derived state
+    Grid& grid = sim.grid;
+    grid.width = header.width;
+    grid.height = header.height;
+    grid.stride = header.stride;
+    grid.origin_x = 0;
+    grid.origin_y = 0;
+    grid.landscape_width = header.width;
+    size_t next = 0;
+    forEachField(grid, [&](const char*, auto& array) {
+        typedef typename std::remove_reference<decltype(array[0])>::type Element;
+        const Element* begin = reinterpret_cast<const Element*>(file.data() + sources[next++]->offset);
+        array.assign(begin, begin + cell_count);
+    });
+    grid.wind_speed = wind_speed;
+    grid.wind_direction = wind_direction;
+    grid.ambient_temp = ambient_temp;
+    grid.humidity = humidity;
+    grid.spread_stencil = static_cast<SpreadStencil>(stencil);
+    grid.update_mode = static_cast<UpdateMode>(mode);
+    grid.rng.setSeed(seed);
+    grid.step_count = step_count;
+    grid.clock = clock;
+    grid.suppression_ends.swap(suppression_ends);
+    grid.rebuildDerivedState();
+
+    sim.human_manager = human;
+    sim.suppression_queue.clear();
+    for (const SuppressionAction& action : actions) {
+        sim.suppression_queue.push(action);
+    }
+    sim.time_step = time_step;
+    sim.total_time = total_time;
+    sim.running = false;
+    sim.updateStatistics();
+    return true;
+}
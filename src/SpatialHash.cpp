@@ -0,0 +1,36 @@
+#include "SpatialHash.h"
+#include <algorithm>
+
+void SpatialHash::insert(int item, int x0, int y0, int x1, int y1) {
+    for (int by = bucketOf(y0); by <= bucketOf(y1); ++by) {
+        for (int bx = bucketOf(x0); bx <= bucketOf(x1); ++bx) {
+            buckets[key(bx, by)].push_back(item);
+        }
+    }
+}
+
+void SpatialHash::remove(int item, int x0, int y0, int x1, int y1) {
+    for (int by = bucketOf(y0); by <= bucketOf(y1); ++by) {
+        for (int bx = bucketOf(x0); bx <= bucketOf(x1); ++bx) {
+            auto bucket = buckets.find(key(bx, by));
+            if (bucket == buckets.end()) continue;
+
+            // Buckets are small and unordered, so swap-and-pop
+            std::vector<int>& items = bucket->second;
+            auto found = std::find(items.begin(), items.end(), item);
+            if (found != items.end()) {
+                *found = items.back();
+                items.pop_back();
+            }
+            if (items.empty()) {
+                buckets.erase(bucket);
+            }
+        }
+    }
+}
+
+void SpatialHash::move(int item, int old_x, int old_y, int new_x, int new_y) {
+    if (bucketOf(old_x) == bucketOf(new_x) && bucketOf(old_y) == bucketOf(new_y)) return;
+    remove(item, old_x, old_y);
+    insert(item, new_x, new_y);
+}
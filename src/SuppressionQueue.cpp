@@ -0,0 +1,20 @@
+#include "SuppressionQueue.h"
+#include "Grid.h"
+
+void SuppressionQueue::apply(Grid& grid) {
+    drops.clear();
+    for (const SuppressionAction& action : pending) {
+        if (action.type == SuppressionType::WATER || action.type == SuppressionType::RETARDANT) {
+            drops.push_back(SuppressionDrop{action.type == SuppressionType::RETARDANT, action.x, action.y,
+                                            action.radius, action.effectiveness, action.duration});
+        }
+    }
+    grid.applyDrops(drops);
+    
+    for (const SuppressionAction& action : pending) {
+        if (action.type == SuppressionType::FIREBREAK) {
+            grid.createFirebreak(action.x, action.y, action.end_x, action.end_y);
+        }
+    }
+    pending.clear();
+}
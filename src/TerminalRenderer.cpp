@@ -0,0 +1,201 @@
+#include "TerminalRenderer.h"
+#include "Grid.h"
+#include "FirefightingCrew.h"
+#include <algorithm>
+#include <cstdio>
+#include <sys/ioctl.h>
+
+namespace {
+// Unchanged characters shorter than this between two changed runs are resent
+// rather than paying for another cursor move
+const int kMaxGap = 8;
+
+// Which character a scaled-down block shows: the highest ranked of its cells
+int significance(char c) {
+    switch (c) {
+        case '*': return 5;
+        case '~': case 'R': case '#': return 4;
+        case 'x': return 3;
+        case '.': case 'o': case 'T': return 2;
+        case ' ': return 0;
+        default: return 1;
+    }
+}
+}
+
+TerminalRenderer::TerminalRenderer(int fd)
+    : terminal_fd(fd), fixed_columns(0), fixed_rows(0), scale(1), view_width(0), view_height(0),
+      drawn(false), last_output_bytes(0) {}
+
+void TerminalRenderer::setTerminalSize(int columns, int rows) {
+    fixed_columns = columns;
+    fixed_rows = rows;
+}
+
+void TerminalRenderer::terminalSize(int& columns, int& rows) const {
+    columns = fixed_columns;
+    rows = fixed_rows;
+    if (columns > 0 && rows > 0) return;
+    
+    struct winsize size;
+    if (ioctl(terminal_fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        columns = size.ws_col;
+        rows = size.ws_row;
+    } else {
+        columns = 80;
+        rows = 24;
+    }
+}
+
+void TerminalRenderer::splitStatus(const std::string& status, int columns) {
+    status_lines.clear();
+    size_t begin = 0;
+    while (begin < status.size()) {
+        size_t end = status.find('\n', begin);
+        if (end == std::string::npos) end = status.size();
+        
+        // Cut long lines at the window edge, never inside a UTF-8 sequence
+        size_t length = std::min(end - begin, static_cast<size_t>(columns));
+        while (length > 0 && length < end - begin && (status[begin + length] & 0xC0) == 0x80) {
+            --length;
+        }
+        status_lines.push_back(status.substr(begin, length));
+        begin = end + 1;
+    }
+}
+
+void TerminalRenderer::composeGrid(const Grid& grid, const HumanFactorManager& human) {
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    int frame_width = view_width + 2;
+    
+    for (int view_y = 0; view_y < view_height; ++view_y) {
+        char* row = &frame[(view_y + 1) * frame_width + 1];
+        if (scale == 1) {
+            for (int x = 0; x < width; ++x) {
+                row[x] = grid.getDisplayChar(x, view_y);
+            }
+            continue;
+        }
+        
+        std::fill(row, row + view_width, ' ');
+        int last_y = std::min(height, (view_y + 1) * scale);
+        for (int y = view_y * scale; y < last_y; ++y) {
+            for (int view_x = 0; view_x < view_width; ++view_x) {
+                char& shown_char = row[view_x];
+                int last_x = std::min(width, (view_x + 1) * scale);
+                for (int x = view_x * scale; x < last_x; ++x) {
+                    char c = grid.getDisplayChar(x, y);
+                    if (significance(c) > significance(shown_char)) shown_char = c;
+                }
+            }
+        }
+    }
+    
+    // Last to first, so the first crew on a cell is the one shown
+    const std::vector<FirefightingCrew>& crews = human.getCrews();
+    for (auto crew = crews.rbegin(); crew != crews.rend(); ++crew) {
+        if (grid.isValidPosition(crew->getX(), crew->getY())) {
+            int view_x = crew->getX() / scale;
+            int view_y = crew->getY() / scale;
+            frame[(view_y + 1) * frame_width + view_x + 1] = crew->getDisplayChar();
+        }
+    }
+}
+
+void TerminalRenderer::moveCursor(int row, int column) {
+    char sequence[32];
+    int length = std::snprintf(sequence, sizeof(sequence), "\x1b[%d;%dH", row + 1, column + 1);
+    output.append(sequence, length);
+}
+
+void TerminalRenderer::render(const Grid& grid, const HumanFactorManager& human,
+                              const std::string& status, std::ostream& out) {
+    int columns, rows;
+    terminalSize(columns, rows);
+    splitStatus(status, columns);
+    
+    // The grid gets what the status leaves, less the border and a line for the cursor
+    int status_rows = static_cast<int>(status_lines.size());
+    int grid_columns = std::max(1, columns - 2);
+    int grid_rows = std::max(1, rows - status_rows - 3);
+    int new_scale = std::max({1, (grid.getWidth() + grid_columns - 1) / grid_columns,
+                              (grid.getHeight() + grid_rows - 1) / grid_rows});
+    int new_width = (grid.getWidth() + new_scale - 1) / new_scale;
+    int new_height = (grid.getHeight() + new_scale - 1) / new_scale;
+    
+    output.clear();
+    if (!drawn || new_scale != scale || new_width != view_width || new_height != view_height ||
+        shown_status.size() != status_lines.size()) {
+        scale = new_scale;
+        view_width = new_width;
+        view_height = new_height;
+        
+        int frame_width = view_width + 2;
+        int frame_height = view_height + 2;
+        frame.assign(static_cast<size_t>(frame_width) * frame_height, ' ');
+        for (int y = 0; y < frame_height; ++y) {
+            bool edge = y == 0 || y == frame_height - 1;
+            frame[y * frame_width] = edge ? '+' : '|';
+            frame[y * frame_width + frame_width - 1] = edge ? '+' : '|';
+            if (edge) std::fill(&frame[y * frame_width + 1], &frame[y * frame_width + frame_width - 1], '-');
+        }
+        // Nothing matches a zero, so the whole frame is sent
+        shown.assign(frame.size(), 0);
+        shown_status.assign(status_lines.size(), std::string(1, '\0'));
+        output += "\x1b[?25l\x1b[H\x1b[2J";
+    }
+    
+    composeGrid(grid, human);
+    
+    // Status lines may hold multi-byte characters, so a changed line is resent whole
+    for (int i = 0; i < status_rows; ++i) {
+        if (status_lines[i] != shown_status[i]) {
+            moveCursor(i, 0);
+            output += status_lines[i];
+            output += "\x1b[K";
+            shown_status[i] = status_lines[i];
+        }
+    }
+    
+    int frame_width = view_width + 2;
+    int frame_height = view_height + 2;
+    for (int y = 0; y < frame_height; ++y) {
+        const char* now = &frame[y * frame_width];
+        const char* before = &shown[y * frame_width];
+        int x = 0;
+        while (x < frame_width) {
+            if (now[x] == before[x]) {
+                ++x;
+                continue;
+            }
+            int begin = x;
+            int end = x + 1;
+            for (x = end; x < frame_width && x - end < kMaxGap; ++x) {
+                if (now[x] != before[x]) end = x + 1;
+            }
+            moveCursor(status_rows + y, begin);
+            output.append(now + begin, end - begin);
+            x = end;
+        }
+    }
+    shown = frame;
+    drawn = true;
+    
+    last_output_bytes = output.size();
+    if (!output.empty()) {
+        out.write(output.data(), static_cast<std::streamsize>(output.size()));
+    }
+    out.flush();
+}
+
+void TerminalRenderer::finish(std::ostream& out) {
+    output.clear();
+    if (drawn) {
+        moveCursor(static_cast<int>(shown_status.size()) + view_height + 2, 0);
+    }
+    output += "\x1b[?25h";
+    out.write(output.data(), static_cast<std::streamsize>(output.size()));
+    out.flush();
+    drawn = false;
+}
@@ -0,0 +1,79 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int thread_count) 
+    : current_invoke(nullptr), current_task(nullptr), task_count(0), next_task(0), busy_workers(0),
+      generation(0), stopping(false) {
+    for (int i = 1; i < thread_count; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::runTasks() {
+    int i;
+    while ((i = next_task.fetch_add(1)) < task_count) {
+        current_invoke(current_task, i);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned seen_generation = 0;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&] { return stopping || generation != seen_generation; });
+            if (stopping) return;
+            seen_generation = generation;
+            ++busy_workers;
+        }
+        
+        runTasks();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busy_workers;
+        }
+        work_done.notify_all();
+    }
+}
+
+void ThreadPool::run(int count, void (*invoke)(const void*, int), const void* task) {
+    if (count <= 0) return;
+    
+    // Nothing to share the work with
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            invoke(task, i);
+        }
+        return;
+    }
+    
+    {
+        // A worker that woke up late for the previous call may still be leaving runTasks
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&] { return busy_workers == 0; });
+        current_invoke = invoke;
+        current_task = task;
+        task_count = count;
+        next_task = 0;
+        ++generation;
+    }
+    work_ready.notify_all();
+    
+    runTasks();
+    
+    // Workers that wake up after this point find no tasks left and leave immediately
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [&] { return busy_workers == 0; });
+}
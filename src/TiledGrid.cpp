@@ -0,0 +1,271 @@
+#include "TiledGrid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+TiledGrid::TiledGrid(FuelLayer fuel_layer, int size)
+    : fuel(std::move(fuel_layer)), width(fuel.getWidth()), height(fuel.getHeight()), tile_size(size),
+      wind_speed(5.0), wind_direction(90.0), ambient_temp(25.0), humidity(0.4),
+      spread_stencil(SpreadStencil::MOORE_8), update_mode(UpdateMode::ACTIVE_FRONT),
+      step_count(0), clock(0.0), thread_pool(nullptr) {
+    tile_columns = (width + tile_size - 1) / tile_size;
+    tile_rows = (height + tile_size - 1) / tile_size;
+    tiles.resize(static_cast<size_t>(tile_columns) * tile_rows);
+
+    // Unseeded grids still vary from run to run; setSeed makes them reproducible
+    std::random_device rd;
+    seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+Grid& TiledGrid::materialize(int tile) {
+    if (tiles[tile]) return *tiles[tile];
+
+    int x0 = tileX0(tile);
+    int y0 = tileY0(tile);
+    std::unique_ptr<Grid> grid(new Grid(std::min(tile_size, width - x0), std::min(tile_size, height - y0)));
+    grid->origin_x = x0;
+    grid->origin_y = y0;
+    grid->landscape_width = width;
+    grid->rng.setSeed(seed);
+    grid->wind_speed = wind_speed;
+    grid->wind_direction = wind_direction;
+    grid->ambient_temp = ambient_temp;
+    grid->humidity = humidity;
+    grid->spread_stencil = spread_stencil;
+    grid->update_mode = update_mode == UpdateMode::BITPLANE ? UpdateMode::ACTIVE_FRONT : update_mode;
+    grid->step_count = step_count;
+    grid->clock = clock;
+    fuel.fill(*grid, x0, y0);
+    grid->rebuildDerivedState();
+
+    tiles[tile] = std::move(grid);
+    materialized.push_back(tile);
+    return *tiles[tile];
+}
+
+Grid& TiledGrid::tileAt(int x, int y) {
+    Grid& grid = materialize(tileOf(x, y));
+    // A tile that was left out of steps has no suppression timers, so its
+    // wheel can jump to the present
+    if (grid.step_count != step_count) {
+        grid.step_count = step_count;
+        grid.clock = clock;
+        grid.suppression_expiries.reset(clock);
+    }
+    return grid;
+}
+
+template <typename Fn>
+void TiledGrid::forEachTileInBox(int x0, int y0, int x1, int y1, Fn&& fn) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width - 1);
+    y1 = std::min(y1, height - 1);
+    if (x0 > x1 || y0 > y1) return;
+    for (int row = y0 / tile_size; row <= y1 / tile_size; ++row) {
+        for (int column = x0 / tile_size; column <= x1 / tile_size; ++column) {
+            fn(row * tile_columns + column);
+        }
+    }
+}
+
+Cell TiledGrid::getCell(int x, int y) const {
+    const Grid* grid = tiles[tileOf(x, y)].get();
+    if (!grid) return fuel.getCell(x, y);
+    return grid->getCell(x % tile_size, y % tile_size);
+}
+
+CellState TiledGrid::getCellState(int x, int y) const {
+    const Grid* grid = tiles[tileOf(x, y)].get();
+    if (!grid) return fuel.getCell(x, y).getState();
+    return grid->getCellState(x % tile_size, y % tile_size);
+}
+
+SuppressionEffect TiledGrid::getSuppressionEffect(int x, int y) const {
+    const Grid* grid = tiles[tileOf(x, y)].get();
+    if (!grid) return SuppressionEffect{0.0, 0.0, 0.0, false};
+    return grid->getSuppressionEffect(x % tile_size, y % tile_size);
+}
+
+void TiledGrid::setCell(int x, int y, const Cell& cell) {
+    if (!isValidPosition(x, y)) return;
+    tileAt(x, y).setCell(x % tile_size, y % tile_size, cell);
+}
+
+void TiledGrid::igniteCell(int x, int y) {
+    if (!isValidPosition(x, y)) return;
+    tileAt(x, y).igniteCell(x % tile_size, y % tile_size);
+}
+
+void TiledGrid::applyWaterDrop(int x, int y, int radius, double effectiveness, double duration) {
+    if (radius < 0) return;
+    forEachTileInBox(x - radius, y - radius, x + radius, y + radius, [&](int tile) {
+        int x0 = tileX0(tile);
+        int y0 = tileY0(tile);
+        tileAt(x0, y0).applyWaterDrop(x - x0, y - y0, radius, effectiveness, duration);
+    });
+}
+
+void TiledGrid::applyRetardant(int x, int y, int radius, double effectiveness, double duration) {
+    if (radius < 0) return;
+    forEachTileInBox(x - radius, y - radius, x + radius, y + radius, [&](int tile) {
+        int x0 = tileX0(tile);
+        int y0 = tileY0(tile);
+        tileAt(x0, y0).applyRetardant(x - x0, y - y0, radius, effectiveness, duration);
+    });
+}
+
+void TiledGrid::createFirebreak(int x1, int y1, int x2, int y2) {
+    // Same line as Grid::createFirebreak, one tile cell at a time
+    int dx = abs(x2 - x1);
+    int dy = abs(y2 - y1);
+    int x = x1;
+    int y = y1;
+    int x_inc = (x1 < x2) ? 1 : -1;
+    int y_inc = (y1 < y2) ? 1 : -1;
+    int error = dx - dy;
+
+    dx *= 2;
+    dy *= 2;
+
+    while (true) {
+        if (isValidPosition(x, y)) {
+            int tile_x = x % tile_size;
+            int tile_y = y % tile_size;
+            tileAt(x, y).createFirebreak(tile_x, tile_y, tile_x, tile_y);
+        }
+
+        if (x == x2 && y == y2) break;
+
+        if (error > 0) {
+            x += x_inc;
+            error -= dy;
+        } else {
+            y += y_inc;
+            error += dx;
+        }
+    }
+}
+
+void TiledGrid::setSeed(uint64_t new_seed) {
+    seed = new_seed;
+    for (int tile : materialized) tiles[tile]->setSeed(seed);
+}
+
+void TiledGrid::setWindSpeed(double speed) {
+    wind_speed = speed;
+    for (int tile : materialized) tiles[tile]->setWindSpeed(speed);
+}
+
+void TiledGrid::setWindDirection(double direction) {
+    wind_direction = direction;
+    for (int tile : materialized) tiles[tile]->setWindDirection(direction);
+}
+
+void TiledGrid::setAmbientTemp(double temp) {
+    ambient_temp = temp;
+    for (int tile : materialized) tiles[tile]->setAmbientTemp(temp);
+}
+
+void TiledGrid::setHumidity(double humid) {
+    humidity = humid;
+    for (int tile : materialized) tiles[tile]->setHumidity(humid);
+}
+
+void TiledGrid::setSpreadStencil(SpreadStencil stencil) {
+    spread_stencil = stencil;
+    for (int tile : materialized) tiles[tile]->setSpreadStencil(stencil);
+}
+
+void TiledGrid::setUpdateMode(UpdateMode mode) {
+    update_mode = mode;
+    UpdateMode tile_mode = mode == UpdateMode::BITPLANE ? UpdateMode::ACTIVE_FRONT : mode;
+    for (int tile : materialized) tiles[tile]->setUpdateMode(tile_mode);
+}
+
+void TiledGrid::collectHaloSources() {
+    const int k = Grid::kHalo;
+    for (int tile : materialized) {
+        tiles[tile]->halo_sources.clear();
+    }
+
+    // Only burning cells within reach of an edge matter. Tiles created here
+    // are appended to the list and have no fire to scan.
+    size_t count = materialized.size();
+    for (size_t i = 0; i < count; ++i) {
+        int tile = materialized[i];
+        const Grid& grid = *tiles[tile];
+        if (grid.burning_count == 0) continue;
+
+        int x0 = tileX0(tile);
+        int y0 = tileY0(tile);
+        for (int y = 0; y < grid.height; ++y) {
+            bool full_row = y < k || y >= grid.height - k || grid.width <= 2 * k;
+            for (int x = 0; x < grid.width; ++x) {
+                if (!full_row && x == k) x = grid.width - k;
+                int idx = grid.index(x, y);
+                if (static_cast<CellState>(grid.states[idx]) != CellState::BURNING) continue;
+
+                int source_x = x0 + x;
+                int source_y = y0 + y;
+                forEachTileInBox(source_x - k, source_y - k, source_x + k, source_y + k, [&](int other) {
+                    if (other == tile) return;
+                    Grid& target = materialize(other);
+                    target.halo_sources.push_back(Grid::HaloSource{source_x - tileX0(other), source_y - tileY0(other),
+                                                                   grid.temperatures[idx]});
+                });
+            }
+        }
+    }
+}
+
+void TiledGrid::update(double dt) {
+    // Every tile's halo is taken from the states before any tile steps
+    collectHaloSources();
+
+    stepping.clear();
+    for (int tile : materialized) {
+        Grid& grid = *tiles[tile];
+        if (grid.burning_count > 0 || !grid.suppression_expiries.empty() || !grid.halo_sources.empty()) {
+            tileAt(tileX0(tile), tileY0(tile));
+            stepping.push_back(tile);
+        }
+    }
+
+    // Tiles only touch their own cells, so they can step in parallel
+    auto step = [&](int i) { tiles[stepping[i]]->update(dt); };
+    if (thread_pool) {
+        thread_pool->parallelFor(static_cast<int>(stepping.size()), step);
+    } else {
+        for (size_t i = 0; i < stepping.size(); ++i) {
+            step(static_cast<int>(i));
+        }
+    }
+
+    clock += dt;
+    ++step_count;
+}
+
+int TiledGrid::getBurningCount() const {
+    int burning = 0;
+    for (int tile : materialized) burning += tiles[tile]->getBurningCount();
+    return burning;
+}
+
+int TiledGrid::getBurnedCount() const {
+    int burned = 0;
+    for (int tile : materialized) burned += tiles[tile]->getBurnedCount();
+    return burned;
+}
+
+size_t TiledGrid::getAllocatedBytes() const {
+    size_t bytes = sizeof(*this) + tiles.capacity() * sizeof(tiles[0]) + materialized.capacity() * sizeof(int) +
+                   fuel.getBytes() - sizeof(fuel);
+    for (int tile : materialized) {
+        const Grid& grid = *tiles[tile];
+        size_t cells = static_cast<size_t>(grid.stride) * (grid.height + 2 * Grid::kHalo);
+        bytes += sizeof(Grid) + cells * grid.getBytesPerCell() + grid.ignite_bits.size() * sizeof(uint64_t);
+    }
+    return bytes;
+}
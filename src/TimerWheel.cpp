@@ -0,0 +1,45 @@
+#include "TimerWheel.h"
+#include <cmath>
+
+TimerWheel::TimerWheel(double tick) : tick_seconds(tick), current_tick(0), count(0) {
+}
+
+int64_t TimerWheel::tickOf(double time) const {
+    return static_cast<int64_t>(std::floor(time / tick_seconds));
+}
+
+void TimerWheel::reset(double time) {
+    for (auto& level : slots) {
+        for (auto& slot : level) slot.clear();
+    }
+    overflow.clear();
+    current_tick = tickOf(time);
+    count = 0;
+}
+
+void TimerWheel::schedule(double deadline, int item) {
+    place(Entry{deadline, item});
+    count++;
+}
+
+void TimerWheel::place(const Entry& entry) {
+    // Past deadlines go into the current tick, which the next advance visits first
+    int64_t tick = std::max(tickOf(entry.deadline), current_tick);
+    int64_t delta = tick - current_tick;
+    for (int level = 0; level < kLevels; ++level) {
+        if (delta < (int64_t(1) << ((level + 1) * kSlotBits))) {
+            slots[level][(tick >> (level * kSlotBits)) & (kSlots - 1)].push_back(entry);
+            return;
+        }
+    }
+    overflow.push_back(entry);
+}
+
+void TimerWheel::cascade(std::vector<Entry>& slot) {
+    if (slot.empty()) return;
+    std::vector<Entry> entries;
+    entries.swap(slot);
+    for (const Entry& entry : entries) {
+        place(entry);
+    }
+}
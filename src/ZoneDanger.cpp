@@ -0,0 +1,131 @@
+#include "ZoneDanger.h"
+#include "FirefightingCrew.h"
+#include "Grid.h"
+#include <algorithm>
+
+ZoneDangerTracker::ZoneDangerTracker()
+    : synced(false), width(0), height(0), x_min(0), y_min(0), x_max(-1), y_max(-1) {
+}
+
+void ZoneDangerTracker::build(const Grid& grid, const std::vector<EvacuationZone>& zones) {
+    width = grid.getWidth();
+    height = grid.getHeight();
+    x_min = y_min = 0;
+    x_max = y_max = -1;
+    cell_slots.clear();
+    slot_cells.clear();
+    slot_states.clear();
+    slot_links.clear();
+    link_zones.clear();
+    link_inside.clear();
+    counts.assign(zones.size(), ZoneCounts{0, 0, 0, 0, 0});
+    synced = true;
+    if (zones.empty()) return;
+
+    // Visits the clipped disk of inside and near cells of a zone
+    auto forEachCovered = [&](const EvacuationZone& zone, auto&& fn) {
+        int64_t inner = zone.radius;
+        int64_t outer = zone.radius + std::max(kNearMargin, zone.radius);
+        int x0 = static_cast<int>(std::max<int64_t>(0, zone.x - outer));
+        int x1 = static_cast<int>(std::min<int64_t>(width - 1, zone.x + outer));
+        int y0 = static_cast<int>(std::max<int64_t>(0, zone.y - outer));
+        int y1 = static_cast<int>(std::min<int64_t>(height - 1, zone.y + outer));
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int64_t dx = x - zone.x, dy = y - zone.y;
+                int64_t distance2 = dx * dx + dy * dy;
+                if (distance2 <= outer * outer) {
+                    fn(x, y, distance2 <= inner * inner);
+                }
+            }
+        }
+    };
+
+    // First pass numbers the covered cells and counts their zones, the
+    // second fills each cell's run of links
+    std::vector<int> link_counts;
+    for (size_t z = 0; z < zones.size(); ++z) {
+        forEachCovered(zones[z], [&](int x, int y, bool inside) {
+            uint64_t cell = static_cast<uint64_t>(y) * width + x;
+            auto slot = cell_slots.emplace(cell, static_cast<int>(link_counts.size()));
+            if (slot.second) {
+                slot_cells.push_back(cell);
+                link_counts.push_back(0);
+                if (x_max < x_min) {
+                    x_min = x_max = x;
+                    y_min = y_max = y;
+                } else {
+                    x_min = std::min(x_min, x);
+                    x_max = std::max(x_max, x);
+                    y_min = std::min(y_min, y);
+                    y_max = std::max(y_max, y);
+                }
+            }
+            ++link_counts[slot.first->second];
+            if (inside) ++counts[z].inside_cells;
+        });
+    }
+
+    slot_links.resize(link_counts.size() + 1);
+    slot_links[0] = 0;
+    for (size_t slot = 0; slot < link_counts.size(); ++slot) {
+        slot_links[slot + 1] = slot_links[slot] + link_counts[slot];
+        link_counts[slot] = slot_links[slot];   // Reused as the fill cursor
+    }
+    link_zones.resize(slot_links.back());
+    link_inside.resize(slot_links.back());
+    for (size_t z = 0; z < zones.size(); ++z) {
+        forEachCovered(zones[z], [&](int x, int y, bool inside) {
+            int link = link_counts[cell_slots[static_cast<uint64_t>(y) * width + x]]++;
+            link_zones[link] = static_cast<int>(z);
+            link_inside[link] = inside ? 1 : 0;
+        });
+    }
+
+    slot_states.resize(slot_cells.size());
+    for (size_t slot = 0; slot < slot_cells.size(); ++slot) {
+        int x = static_cast<int>(slot_cells[slot] % width);
+        int y = static_cast<int>(slot_cells[slot] / width);
+        slot_states[slot] = static_cast<uint8_t>(grid.getCellState(x, y));
+        count(static_cast<int>(slot), slot_states[slot], 1);
+    }
+}
+
+void ZoneDangerTracker::count(int slot, uint8_t state, int delta) {
+    bool burning = state == static_cast<uint8_t>(CellState::BURNING);
+    bool burned = state == static_cast<uint8_t>(CellState::BURNED);
+    if (!burning && !burned) return;
+    for (int link = slot_links[slot]; link < slot_links[slot + 1]; ++link) {
+        ZoneCounts& zone = counts[link_zones[link]];
+        if (link_inside[link]) {
+            (burning ? zone.burning_inside : zone.burned_inside) += delta;
+        } else {
+            (burning ? zone.burning_near : zone.burned_near) += delta;
+        }
+    }
+}
+
+void ZoneDangerTracker::update(const Grid& grid, std::vector<EvacuationZone>& zones) {
+    if (!synced || width != grid.getWidth() || height != grid.getHeight() || counts.size() != zones.size()) {
+        build(grid, zones);
+    } else if (!zones.empty()) {
+        grid.forEachChangedCell([&](int x, int y, CellState state) {
+            if (x < x_min || x > x_max || y < y_min || y > y_max) return;
+            auto found = cell_slots.find(static_cast<uint64_t>(y) * width + x);
+            if (found == cell_slots.end()) return;
+            int slot = found->second;
+            uint8_t now = static_cast<uint8_t>(state);
+            if (slot_states[slot] == now) return;
+            count(slot, slot_states[slot], -1);
+            count(slot, now, 1);
+            slot_states[slot] = now;
+        });
+    }
+
+    for (size_t z = 0; z < zones.size(); ++z) {
+        const ZoneCounts& zone = counts[z];
+        double weighted = zone.burning_inside + 0.5 * zone.burning_near + 0.25 * zone.burned_inside;
+        double scale = 0.1 * std::max(1, zone.inside_cells);
+        zones[z].danger_level = std::min(1.0, weighted / scale);
+    }
+}
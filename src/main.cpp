@@ -1,6 +1,12 @@
 #include "FireSimulation.h"
+#include "BatchRunner.h"
 #include <iostream>
 #include <string>
+#include <cstdlib>
+#include <algorithm>
+
+// Worker threads for Grid::update, set with --threads N
+static int thread_count = 1;
 
 void printMenu() {
     std::cout << "\n=== Wildfire Simulation ===\n";
@@ -44,6 +50,7 @@ void setupFirefightingCrews(FireSimulation& sim, const std::string& scenario) {
 
 void runSimulation(FireSimulation& sim, const std::string& scenario) {
     std::cout << "\nStarting " << scenario << " simulation...\n";
+    sim.setThreadCount(thread_count);
     
     // Set up firefighting crews for this scenario
     setupFirefightingCrews(sim, scenario);
@@ -175,7 +182,31 @@ void humanFactorsDemo() {
     runSimulation(sim, "demo");
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --batch anywhere on the command line runs headless and skips the menu
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--batch") {
+            BatchOptions options;
+            std::string error;
+            if (!parseBatchOptions(argc, argv, options, error)) {
+                std::cerr << argv[0] << ": " << error << "\n";
+                printBatchUsage(argv[0]);
+                return 1;
+            }
+            return runBatch(options);
+        }
+    }
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            thread_count = std::max(1, std::atoi(argv[++i]));
+        } else {
+            printBatchUsage(argv[0]);
+            return 1;
+        }
+    }
+    
     std::cout << "Welcome to the Wildfire Simulation!\n";
     std::cout << "This simulation models fire spread across different terrains.\n";
     